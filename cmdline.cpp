@@ -0,0 +1,874 @@
+/**
+ * cmdline.cpp - split Windows-style command lines.
+ * a portable C++ implementation for Microsoft Windows and GNU/Linux.
+ *
+ * the splitter keeps a few bits of state from one block of 64 characters
+ * to the next: whether the block starts inside quotes, within an argument,
+ * or after an odd run of backslashes. masks of the backslashes, quotes and
+ * blanks of a block then give the escaped quotes (by carrying additions
+ * through the backslash runs), the quoted parts (by a prefix XOR of the
+ * other quotes) and the delimiters, and only quotes and the edges of
+ * delimiter runs are visited; the text between them is copied in spans.
+ * a backslash run is copied as it is and cut back when a quote follows.
+ * runs of quotes, which count modulo three, stay in the masks as well:
+ * the same carrying additions, from the starts of the runs grouped by
+ * their index modulo three, tell which quotes are literal and whether a
+ * run enters, leaves or keeps the quoted part.
+ * the visits cost about what the scalar rules cost per character, so the
+ * gain shrinks as arguments and quotes get denser: about 1.3x on the
+ * short, plain arguments of cmdline_bench, less on its quoted ones.
+ *
+ * free to distribute under the GPL license.
+ * if you have not received a copy of the license along with the code,
+ * confer to http://www.gnu.org/licenses/gpl.html
+ *
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ */
+
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include "cmdline.h"
+
+#if defined(__AVX2__)
+#   include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   include <emmintrin.h>
+#   define CMDLINE_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+
+/* cmdlpbrk, moved here from sudo.c. */
+extern "C" const wchar_t*
+cmdlpbrk(const wchar_t* cmdl, const wchar_t* delims)
+{
+    const wchar_t* pwc = cmdl;
+    bool quote = false; /* next char is not quoted */
+    bool esc = false; /* next char is not escaped */
+
+    /* '\"' and '\\' not allowed in delims */
+    assert(wcscspn(delims, L"\"\\") == wcslen(delims));
+
+    for ( ; *pwc ; ++pwc)
+    {
+        switch(*pwc)
+          {
+            case L'\\':
+                esc = !esc;
+                break;
+            case L'"':
+                if (!esc) { quote = !quote; }
+                break;
+            default:
+                esc = false;
+                if (!quote && wcschr(delims, *pwc)) { return pwc; }
+          }
+    }
+
+    return NULL;
+}
+
+
+namespace
+{
+
+enum { BlockSize = 64 };
+
+inline unsigned ctz(uint64_t x)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return i;
+#elif defined(_MSC_VER)
+    unsigned long i;
+    if (_BitScanForward(&i, (unsigned long)x)) return i;
+    _BitScanForward(&i, (unsigned long)(x >> 32));
+    return i + 32;
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+inline unsigned clz(uint64_t x)
+{
+#if defined(_MSC_VER) && defined(_WIN64)
+    unsigned long i;
+    _BitScanReverse64(&i, x);
+    return 63 - i;
+#elif defined(_MSC_VER)
+    unsigned long i;
+    if (_BitScanReverse(&i, (unsigned long)(x >> 32))) return 31 - i;
+    _BitScanReverse(&i, (unsigned long)x);
+    return 63 - i;
+#else
+    return __builtin_clzll(x);
+#endif
+}
+
+/**
+ * bit i set if an odd number of bits at or below i are set.
+ */
+inline uint64_t prefixXor(uint64_t x)
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+
+/**
+ * the backslashes, double quotes and blanks of a block, one bit each.
+ */
+struct Masks
+{
+    uint64_t bs;
+    uint64_t quote;
+    uint64_t blank;
+};
+
+template <class Ch>
+inline void scanScalar(const Ch *p, Masks& m)
+{
+    m.bs = m.quote = m.blank = 0;
+    for (unsigned i = 0; i < BlockSize; ++i)
+    {
+        uint64_t bit = uint64_t(1) << i;
+        Ch c = p[i];
+        if (c == '\\') m.bs |= bit;
+        if (c == '"') m.quote |= bit;
+        if (c == ' ' || c == '\t') m.blank |= bit;
+    }
+}
+
+#if defined(__AVX2__)
+
+/* 32 bytes of comparison results to 32 bits, 32 units to 32 bits. */
+inline uint32_t bits8(__m256i eq)
+{
+    return (uint32_t)_mm256_movemask_epi8(eq);
+}
+
+inline uint32_t bits16(__m256i lo, __m256i hi)
+{
+    /* packing works within each 128-bit lane; put the quarters in order. */
+    __m256i packed = _mm256_packs_epi16(lo, hi);
+    return (uint32_t)_mm256_movemask_epi8(_mm256_permute4x64_epi64(packed, 0xD8));
+}
+
+inline void scan(const char *p, Masks& m)
+{
+    const __m256i bs = _mm256_set1_epi8('\\');
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+
+    m.bs = m.quote = m.blank = 0;
+    for (unsigned i = 0; i < BlockSize; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+        m.bs |= uint64_t(bits8(_mm256_cmpeq_epi8(v, bs))) << i;
+        m.quote |= uint64_t(bits8(_mm256_cmpeq_epi8(v, quote))) << i;
+        m.blank |= uint64_t(bits8(_mm256_or_si256(_mm256_cmpeq_epi8(v, space),
+                                                  _mm256_cmpeq_epi8(v, tab)))) << i;
+    }
+}
+
+inline void scan(const char16_t *p, Masks& m)
+{
+    const __m256i bs = _mm256_set1_epi16('\\');
+    const __m256i quote = _mm256_set1_epi16('"');
+    const __m256i space = _mm256_set1_epi16(' ');
+    const __m256i tab = _mm256_set1_epi16('\t');
+
+    m.bs = m.quote = m.blank = 0;
+    for (unsigned i = 0; i < BlockSize; i += 32)
+    {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i + 16));
+        m.bs |= uint64_t(bits16(_mm256_cmpeq_epi16(a, bs),
+                                _mm256_cmpeq_epi16(b, bs))) << i;
+        m.quote |= uint64_t(bits16(_mm256_cmpeq_epi16(a, quote),
+                                   _mm256_cmpeq_epi16(b, quote))) << i;
+        m.blank |= uint64_t(bits16(_mm256_or_si256(_mm256_cmpeq_epi16(a, space),
+                                                   _mm256_cmpeq_epi16(a, tab)),
+                                   _mm256_or_si256(_mm256_cmpeq_epi16(b, space),
+                                                   _mm256_cmpeq_epi16(b, tab)))) << i;
+    }
+}
+
+#elif defined(CMDLINE_SSE2)
+
+inline void scan(const char *p, Masks& m)
+{
+    const __m128i bs = _mm_set1_epi8('\\');
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+
+    m.bs = m.quote = m.blank = 0;
+    for (unsigned i = 0; i < BlockSize; i += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        m.bs |= uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, bs))) << i;
+        m.quote |= uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote))) << i;
+        m.blank |= uint64_t(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, space),
+                                                           _mm_cmpeq_epi8(v, tab)))) << i;
+    }
+}
+
+inline void scan(const char16_t *p, Masks& m)
+{
+    const __m128i bs = _mm_set1_epi16('\\');
+    const __m128i quote = _mm_set1_epi16('"');
+    const __m128i space = _mm_set1_epi16(' ');
+    const __m128i tab = _mm_set1_epi16('\t');
+
+    m.bs = m.quote = m.blank = 0;
+    for (unsigned i = 0; i < BlockSize; i += 16)
+    {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i + 8));
+        m.bs |= uint64_t(_mm_movemask_epi8(
+                    _mm_packs_epi16(_mm_cmpeq_epi16(a, bs),
+                                    _mm_cmpeq_epi16(b, bs)))) << i;
+        m.quote |= uint64_t(_mm_movemask_epi8(
+                    _mm_packs_epi16(_mm_cmpeq_epi16(a, quote),
+                                    _mm_cmpeq_epi16(b, quote)))) << i;
+        m.blank |= uint64_t(_mm_movemask_epi8(
+                    _mm_packs_epi16(_mm_or_si128(_mm_cmpeq_epi16(a, space),
+                                                 _mm_cmpeq_epi16(a, tab)),
+                                    _mm_or_si128(_mm_cmpeq_epi16(b, space),
+                                                 _mm_cmpeq_epi16(b, tab))))) << i;
+    }
+}
+
+#else
+
+template <class Ch>
+inline void scan(const Ch *p, Masks& m)
+{
+    scanScalar(p, m);
+}
+
+#endif
+
+
+/**
+ * the characters following an odd run of backslashes.
+ * `carry' is 1 if the previous block ended in one, and is updated.
+ */
+inline uint64_t escaped(uint64_t bs, uint64_t& carry)
+{
+    const uint64_t even = 0x5555555555555555ULL;
+    const uint64_t odd = ~even;
+
+    uint64_t starts = bs & ~(bs << 1);
+    uint64_t evenStartMask = even ^ carry;
+    uint64_t evenStarts = starts & evenStartMask;
+    uint64_t oddStarts = starts & ~evenStartMask;
+
+    /* adding the start of a run to it carries to just past its end. */
+    uint64_t evenCarries = bs + evenStarts;
+    uint64_t oddCarries = bs + oddStarts;
+    bool overflow = (oddCarries < bs);
+    oddCarries |= carry;
+    carry = overflow ? 1 : 0;
+
+    uint64_t evenEnds = evenCarries & ~bs & odd;
+    uint64_t oddEnds = oddCarries & ~bs & even;
+    return evenEnds | oddEnds;
+}
+
+
+/**
+ * the bits whose index is 0, 1 or 2 modulo three.
+ */
+const uint64_t Mod3[3] =
+{
+    0x9249249249249249ULL,
+    0x2492492492492492ULL,
+    0x4924924924924924ULL
+};
+
+/**
+ * the runs of `set' that start at a bit of `starts'.
+ */
+inline uint64_t runsFrom(uint64_t set, uint64_t starts)
+{
+    /* adding the start of a run to it carries to just past its end. */
+    return ((set + starts) ^ set) & set;
+}
+
+
+/**
+ * the block of [s, s + len) at `i', with its masks; a short last block is
+ * padded into `tail'. returns the number of characters that count.
+ */
+template <class Ch>
+inline size_t load(const Ch *s, size_t len, size_t i, Ch *tail, const Ch *&p, Masks& m)
+{
+    size_t n = len - i;
+    p = s + i;
+    if (n < BlockSize)
+    {
+        /* pad with characters of no meaning. */
+        memcpy(tail, p, n * sizeof(Ch));
+        for (size_t k = n; k < BlockSize; ++k) tail[k] = 'x';
+        p = tail;
+    }
+    else
+    {
+        n = BlockSize;
+    }
+    scan(p, m);
+    return n;
+}
+
+/**
+ * the length of the backslash run just before position `k' of a block,
+ * `carried' being the one the block starts in.
+ */
+inline size_t runBefore(uint64_t bs, size_t k, size_t carried)
+{
+    if (k == 0) return carried;
+    uint64_t rest = ~(bs << (BlockSize - k));
+    size_t run = BlockSize;
+    if (rest) run = clz(rest);
+    return (run == k) ? carried + run : run;
+}
+
+
+/**
+ * the state of the splitter between characters.
+ */
+template <class Ch>
+struct Splitter
+{
+    Ch *out;
+    Ch **argv;
+    size_t maxargs;
+    size_t argc;
+    bool inArg;         /* an argument is being written */
+    unsigned quotes;    /* 1 inside quotes; a run of quotes counts to 2 */
+    bool inRun;         /* the last character was a double quote */
+    size_t backslashes; /* the length of the backslash run just written */
+
+    Splitter(Ch *buf, Ch **v, size_t max)
+        : out(buf),
+          argv(v),
+          maxargs(max),
+          argc(0),
+          inArg(false),
+          quotes(0),
+          inRun(false),
+          backslashes(0)
+    {
+    }
+
+    void begin()
+    {
+        if (argc < maxargs) argv[argc] = out;
+        ++argc;
+        inArg = true;
+    }
+
+    void end()
+    {
+        *out++ = 0;
+        inArg = false;
+    }
+
+    /**
+     * the program name; returns where the other arguments start.
+     */
+    size_t program(const Ch *s, size_t len)
+    {
+        size_t i = 0;
+        if (len == 0) return 0;
+
+        begin();
+        if (s[0] == '"')
+        {
+            for (i = 1; i < len && s[i] != '"'; ++i) *out++ = s[i];
+            if (i < len) ++i;
+        }
+        else
+        {
+            for (; i < len && s[i] != ' ' && s[i] != '\t'; ++i) *out++ = s[i];
+        }
+        end();
+
+        while (i < len && (s[i] == ' ' || s[i] == '\t')) ++i;
+        return i;
+    }
+
+    /**
+     * the rules, one character at a time.
+     */
+    void step(Ch c)
+    {
+        if (inRun && c != '"')
+        {
+            if (quotes == 2) quotes = 0;
+            inRun = false;
+        }
+
+        if ((c == ' ' || c == '\t') && quotes == 0)
+        {
+            if (inArg) end();
+            backslashes = 0;
+            return;
+        }
+
+        if (!inArg) begin();
+
+        if (c == '\\')
+        {
+            *out++ = c;
+            ++backslashes;
+            return;
+        }
+
+        if (c == '"')
+        {
+            if (inRun)
+            {
+                /* every third quote of a run is literal. */
+                if (++quotes == 3)
+                {
+                    *out++ = c;
+                    quotes = 0;
+                }
+                return;
+            }
+
+            if (backslashes % 2 == 0)
+            {
+                out -= backslashes / 2;
+                ++quotes;
+            }
+            else
+            {
+                out -= backslashes / 2 + 1;
+                *out++ = c;
+            }
+            backslashes = 0;
+            inRun = true;
+            return;
+        }
+
+        *out++ = c;
+        backslashes = 0;
+    }
+
+    size_t finish()
+    {
+        if (inArg) end();
+        return argc;
+    }
+};
+
+
+template <class Ch>
+size_t splitScalar(const Ch *cmdl, size_t len, Ch *buf, Ch **argv, size_t maxargs)
+{
+    Splitter<Ch> s(buf, argv, maxargs);
+    for (size_t i = s.program(cmdl, len); i < len; ++i) s.step(cmdl[i]);
+    return s.finish();
+}
+
+
+template <class Ch>
+size_t split(const Ch *cmdl, size_t len, Ch *buf, Ch **argv, size_t maxargs)
+{
+    Splitter<Ch> s(buf, argv, maxargs);
+    size_t i = s.program(cmdl, len);
+
+    uint64_t oddCarry = 0;  /* the last block ended in an odd backslash run */
+    bool afterBlank = true; /* the last block ended in a delimiter */
+
+    for (; i < len; i += BlockSize)
+    {
+        Ch tail[BlockSize];
+        const Ch *p;
+        Masks m;
+        size_t n = load(cmdl, len, i, tail, p, m);
+        uint64_t valid = (n == BlockSize) ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+
+        uint64_t esc = escaped(m.bs, oddCarry);
+        uint64_t counted = m.quote & ~esc;
+        uint64_t literal = 0;
+
+        /**
+         * a run of quotes carried over from the last block goes on from
+         * its count; the state past it is that of the rest of the block.
+         */
+        bool carried = s.inRun && (m.quote & 1);
+        unsigned count = s.quotes;
+        unsigned state = count;
+        if (carried)
+        {
+            unsigned run = (~counted) ? ctz(~counted) : unsigned(BlockSize);
+            uint64_t bits = (run < BlockSize) ? (uint64_t(1) << run) - 1 : ~uint64_t(0);
+            literal = bits & Mod3[(5 - count) % 3];
+            state = ((count + run) % 3 == 1) ? 1 : 0;
+        }
+        else if (s.inRun && count == 2)
+        {
+            state = 0;
+        }
+
+        /**
+         * the n-th quote of a run (counting the one opening a quoted
+         * part) is literal if n is a multiple of three; a run of 3k + 1
+         * quotes enters or leaves a quoted part, one of 3k + 2 leaves it,
+         * and one of 3k changes nothing. grouping the runs by their start
+         * modulo three tells, by their ends, what they do.
+         */
+        uint64_t opens = counted & ~((counted << 1) | (carried ? 1 : 0));
+        uint64_t toggles = opens;
+        uint64_t resets = 0;
+        bool runs = (counted & (counted << 1)) != 0;
+        if (runs)
+        {
+            uint64_t last = counted & ~(counted >> 1);
+            toggles = 0;
+            for (unsigned c = 0; c < 3; ++c)
+            {
+                uint64_t ends = runsFrom(counted, opens & Mod3[c]) & last;
+                toggles |= ends & Mod3[c];
+                resets |= ends & Mod3[(c + 1) % 3];
+            }
+        }
+
+        uint64_t inside = prefixXor(toggles);
+        if (state) inside = ~inside;
+        for (uint64_t r = resets; r; r &= r - 1)
+        {
+            unsigned k = ctz(r);
+            if ((inside >> k) & 1) inside ^= ~uint64_t(0) << k;
+        }
+
+        /* a run started outside quotes counts from 0, inside from 1. */
+        uint64_t before = (inside << 1) | state;
+        if (runs)
+        {
+            uint64_t in = opens & before;
+            uint64_t out = opens & ~before;
+            for (unsigned c = 0; c < 3; ++c)
+            {
+                literal |= runsFrom(counted, (out & Mod3[(c + 1) % 3]) |
+                                             (in & Mod3[(c + 2) % 3])) & Mod3[c];
+            }
+        }
+
+        /* a run of quotes at the end may go on in the next block. */
+        s.inRun = (m.quote >> (n - 1)) & 1;
+        s.quotes = (inside >> (n - 1)) & 1;
+        if ((counted >> (n - 1)) & 1)
+        {
+            uint64_t first = opens & valid;
+            if (!first)
+            {
+                s.quotes = (count + n) % 3;     /* carried through */
+            }
+            else
+            {
+                unsigned k = BlockSize - 1 - clz(first);
+                s.quotes = (((before >> k) & 1) + n - k) % 3;
+            }
+        }
+
+        uint64_t delim = m.blank & ~inside;
+        uint64_t prev = (delim << 1) | (afterBlank ? 1 : 0);
+        uint64_t starts = ~delim & prev & valid;
+        uint64_t ends = delim & ~prev & valid;
+
+        size_t from = 0;    /* the part of the block not copied yet */
+        for (uint64_t events = (m.quote | starts | ends) & valid; events; events &= events - 1)
+        {
+            unsigned k = ctz(events);
+            uint64_t bit = uint64_t(1) << k;
+
+            if (ends & bit)
+            {
+                memcpy(s.out, p + from, (k - from) * sizeof(Ch));
+                s.out += k - from;
+                s.end();
+                continue;
+            }
+
+            if (starts & bit)
+            {
+                s.begin();
+                from = k;
+                if (!(m.quote & bit)) continue;
+            }
+
+            memcpy(s.out, p + from, (k - from) * sizeof(Ch));
+            s.out += k - from;
+            from = k + 1;
+
+            size_t run = runBefore(m.bs, k, s.backslashes);
+
+            if (esc & bit)
+            {
+                s.out -= run / 2 + 1;
+                *s.out++ = '"';
+            }
+            else
+            {
+                s.out -= run / 2;
+                if (literal & bit) *s.out++ = '"';
+            }
+        }
+
+        if (s.inArg)
+        {
+            memcpy(s.out, p + from, (n - from) * sizeof(Ch));
+            s.out += n - from;
+        }
+
+        s.backslashes = runBefore(m.bs, n, s.backslashes);
+        afterBlank = (delim >> (n - 1)) & 1;
+    }
+
+    return s.finish();
+}
+
+
+/**
+ * how an argument goes into a command line.
+ */
+struct Quoting
+{
+    size_t len;     /* of the argument */
+    size_t size;    /* of its form in the command line */
+    bool quoted;
+};
+
+template <class Ch>
+inline size_t length(const Ch *s)
+{
+    return std::char_traits<Ch>::length(s);
+}
+
+/**
+ * the program name is quoted if it is empty, starts with a quote or holds
+ * blanks, and is taken as it is; a quoted one cannot hold a quote.
+ */
+template <class Ch>
+bool measureProgram(const Ch *prog, Quoting& q)
+{
+    uint64_t blanks = 0;
+    uint64_t quotes = 0;
+
+    q.len = length(prog);
+    for (size_t i = 0; i < q.len; i += BlockSize)
+    {
+        Ch tail[BlockSize];
+        const Ch *p;
+        Masks m;
+        load(prog, q.len, i, tail, p, m);
+        blanks |= m.blank;
+        quotes |= m.quote;
+    }
+
+    q.quoted = (q.len == 0 || prog[0] == '"' || blanks != 0);
+    q.size = q.quoted ? q.len + 2 : q.len;
+    return !(q.quoted && quotes);
+}
+
+/**
+ * any other argument is quoted if it is empty or holds blanks or quotes;
+ * then each quote takes a backslash, and the backslashes before a quote
+ * or the closing quote are doubled.
+ */
+template <class Ch>
+Quoting measure(const Ch *arg)
+{
+    Quoting q;
+    uint64_t special = 0;
+    size_t extra = 0;
+    size_t backslashes = 0;
+
+    q.len = length(arg);
+    for (size_t i = 0; i < q.len; i += BlockSize)
+    {
+        Ch tail[BlockSize];
+        const Ch *p;
+        Masks m;
+        size_t n = load(arg, q.len, i, tail, p, m);
+
+        special |= m.quote | m.blank;
+        for (uint64_t quotes = m.quote; quotes; quotes &= quotes - 1)
+        {
+            extra += 1 + runBefore(m.bs, ctz(quotes), backslashes);
+        }
+        backslashes = runBefore(m.bs, n, backslashes);
+    }
+
+    q.quoted = (q.len == 0 || special != 0);
+    q.size = q.quoted ? q.len + extra + backslashes + 2 : q.len;
+    return q;
+}
+
+template <class Ch>
+size_t measureAll(const Ch *const *argv, size_t argc)
+{
+    if (argc == 0) return 1;
+
+    Quoting q;
+    if (!measureProgram(argv[0], q)) return 0;
+
+    size_t size = q.size + 1;
+    for (size_t i = 1; i < argc; ++i) size += 1 + measure(argv[i]).size;
+    return size;
+}
+
+template <class Ch>
+Ch *emitProgram(const Ch *prog, Ch *out)
+{
+    Quoting q;
+    measureProgram(prog, q);
+
+    if (q.quoted) *out++ = '"';
+    memcpy(out, prog, q.len * sizeof(Ch));
+    out += q.len;
+    if (q.quoted) *out++ = '"';
+    return out;
+}
+
+/**
+ * write an argument as measure() sized it, in a single scan: it is copied
+ * as it is until a block shows that it needs quoting.
+ */
+template <class Ch>
+Ch *emit(const Ch *arg, Ch *out)
+{
+    Ch *start = out;
+    bool quoted = false;
+    size_t backslashes = 0;
+    size_t len = length(arg);
+
+    for (size_t i = 0; i < len; i += BlockSize)
+    {
+        Ch tail[BlockSize];
+        const Ch *p;
+        Masks m;
+        size_t n = load(arg, len, i, tail, p, m);
+
+        if (!quoted && (m.quote | m.blank))
+        {
+            memmove(start + 1, start, (out - start) * sizeof(Ch));
+            *start = '"';
+            ++out;
+            quoted = true;
+        }
+
+        size_t from = 0;
+        for (uint64_t quotes = m.quote; quotes; quotes &= quotes - 1)
+        {
+            unsigned k = ctz(quotes);
+            memcpy(out, p + from, (k - from) * sizeof(Ch));
+            out += k - from;
+            from = k + 1;
+
+            for (size_t run = runBefore(m.bs, k, backslashes); run; --run) *out++ = '\\';
+            *out++ = '\\';
+            *out++ = '"';
+        }
+        memcpy(out, p + from, (n - from) * sizeof(Ch));
+        out += n - from;
+        backslashes = runBefore(m.bs, n, backslashes);
+    }
+
+    if (len == 0)
+    {
+        *out++ = '"';
+        quoted = true;
+    }
+    if (quoted)
+    {
+        for (; backslashes; --backslashes) *out++ = '\\';
+        *out++ = '"';
+    }
+    return out;
+}
+
+template <class Ch>
+size_t emitAll(const Ch *const *argv, size_t argc, Ch *buf)
+{
+    Ch *out = buf;
+    if (argc) out = emitProgram(argv[0], out);
+    for (size_t i = 1; i < argc; ++i)
+    {
+        *out++ = ' ';
+        out = emit(argv[i], out);
+    }
+    *out = 0;
+    return out - buf;
+}
+
+}   // namespace
+
+
+template <class Ch>
+size_t cmdl_split(const Ch *cmdl, size_t len, Ch *buf, Ch **argv, size_t maxargs)
+{
+    return split(cmdl, len, buf, argv, maxargs);
+}
+
+template <class Ch>
+size_t cmdl_split_scalar(const Ch *cmdl, size_t len, Ch *buf, Ch **argv, size_t maxargs)
+{
+    return splitScalar(cmdl, len, buf, argv, maxargs);
+}
+
+template <class Ch>
+size_t cmdl_quote_size(const Ch *const *argv, size_t argc)
+{
+    return measureAll(argv, argc);
+}
+
+template <class Ch>
+size_t cmdl_quote(const Ch *const *argv, size_t argc, Ch *buf, size_t size)
+{
+    size_t need = measureAll(argv, argc);
+    if (need == 0 || need > size) return 0;
+    return emitAll(argv, argc, buf);
+}
+
+template <class Ch>
+Ch *cmdl_quote(const Ch *const *argv, size_t argc)
+{
+    size_t need = measureAll(argv, argc);
+    if (need == 0) return NULL;
+
+    Ch *buf = static_cast<Ch *>(malloc(need * sizeof(Ch)));
+    if (buf) emitAll(argv, argc, buf);
+    return buf;
+}
+
+template size_t cmdl_split<char>(const char *, size_t, char *, char **, size_t);
+template size_t cmdl_split<char16_t>(const char16_t *, size_t, char16_t *, char16_t **, size_t);
+template size_t cmdl_split_scalar<char>(const char *, size_t, char *, char **, size_t);
+template size_t cmdl_split_scalar<char16_t>(const char16_t *, size_t, char16_t *, char16_t **, size_t);
+template size_t cmdl_quote_size<char>(const char *const *, size_t);
+template size_t cmdl_quote_size<char16_t>(const char16_t *const *, size_t);
+template size_t cmdl_quote<char>(const char *const *, size_t, char *, size_t);
+template size_t cmdl_quote<char16_t>(const char16_t *const *, size_t, char16_t *, size_t);
+template char *cmdl_quote<char>(const char *const *, size_t);
+template char16_t *cmdl_quote<char16_t>(const char16_t *const *, size_t);
@@ -0,0 +1,87 @@
+#ifndef CMDLINE_H_INCLUDED
+#define CMDLINE_H_INCLUDED
+
+/**
+ * cmdline - split Windows-style command lines.
+ * free to distribute under the GPL license.
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ *
+ * cmdl_split follows the rules of CommandLineToArgvW:
+ * - the program name (argv[0]) runs up to the first space or tab,
+ *   or, if it begins with a double quote, up to the next double quote;
+ * - other arguments are separated by spaces and tabs outside quotes;
+ * - 2n backslashes followed by a double quote give n backslashes, and the
+ *   quote begins or ends a quoted part; 2n+1 backslashes followed by a
+ *   double quote give n backslashes and a literal quote;
+ * - backslashes not followed by a double quote are literal;
+ * - within a run of double quotes, every third quote (counting the one
+ *   that opened the quoted part) is a literal quote, so "" inside quotes
+ *   gives a quote and ends the quoted part.
+ * cmdl_split finds quotes, backslashes and delimiters 64 characters at a
+ * time with SSE2 or AVX2 masks; cmdl_split_scalar is the reference.
+ *
+ * cmdl_quote does the reverse, joining arguments into a command line that
+ * splits back into them: one scan of the same masks sizes the result
+ * exactly, a second writes it into the caller's buffer or one allocation.
+ */
+
+#include <stddef.h>
+#include <wchar.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* cmdlpbrk "command line pointer break"
+ * returns a pointer to the first occurance in cmdl of any character in delims,
+ * or a null pointer if there are no matches.
+ * characters in a double quoted string are treated literally.
+ * a double quotation mark begins/ends a quoted string,
+ * unless it's following an odd number of backslashes and treated literally.
+ * delims shall not contain the double quotation mark or the backslash.
+ */
+const wchar_t* cmdlpbrk(const wchar_t* cmdl, const wchar_t* delims);
+
+#if defined(__cplusplus)
+}   /* extern "C" */
+
+/**
+ * split the command line [cmdl, cmdl + len) into NUL-terminated arguments
+ * stored in `buf' (len + 1 characters always suffice), pointing the first
+ * `maxargs' entries of `argv' at them.
+ * returns the number of arguments, which may exceed `maxargs'.
+ * Ch is char or char16_t.
+ */
+template <class Ch>
+size_t cmdl_split(const Ch *cmdl, size_t len, Ch *buf, Ch **argv, size_t maxargs);
+
+template <class Ch>
+size_t cmdl_split_scalar(const Ch *cmdl, size_t len, Ch *buf, Ch **argv, size_t maxargs);
+
+/**
+ * the characters, with the terminating NUL, that cmdl_quote needs for
+ * argv[0..argc), or 0 if the arguments cannot be quoted: a program name
+ * that is empty, starts with a double quote or holds blanks is quoted as
+ * it is, and then cannot hold a double quote.
+ */
+template <class Ch>
+size_t cmdl_quote_size(const Ch *const *argv, size_t argc);
+
+/**
+ * quote argv[0..argc) into `buf' of `size' characters.
+ * returns the length of the command line, or 0 if it does not fit or the
+ * arguments cannot be quoted (an empty list gives an empty line).
+ */
+template <class Ch>
+size_t cmdl_quote(const Ch *const *argv, size_t argc, Ch *buf, size_t size);
+
+/**
+ * quote argv[0..argc) into a single allocation, to be released with free().
+ * returns NULL if memory runs out or the arguments cannot be quoted.
+ */
+template <class Ch>
+Ch *cmdl_quote(const Ch *const *argv, size_t argc);
+
+#endif
+
+#endif  /* CMDLINE_H_INCLUDED */
@@ -0,0 +1,243 @@
+/**
+ * cmdline_bench.cpp - throughput of the command line splitter and quoter.
+ * times cmdl_split against cmdl_split_scalar on a long synthetic command
+ * line of plain, quoted and escaped arguments, for char and char16_t.
+ * both must give the same arguments, and the ratio of their speeds is
+ * reported for each line. the arguments are then quoted back into a
+ * command line with cmdl_quote, which must split into them again.
+ *
+ * build: g++ -O2 -std=c++17 cmdline_bench.cpp cmdline.cpp
+ *        (add -mavx2 to time the AVX2 scan instead of SSE2)
+ *
+ * SYNOPSIS: cmdline_bench [-l length] [-r rounds]
+ *
+ * free to distribute under the GPL license.
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ */
+
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "cmdline.h"
+
+
+/**
+ * a command line of about `len' characters: a deterministic mix of
+ * options and paths, and with `quoted', of quoted paths with blanks,
+ * escaped quotes and backslash runs as well.
+ */
+template <class Ch>
+static std::basic_string<Ch> makeLine(std::size_t len, bool quoted)
+{
+    static const char *const words[] =
+    {
+        "-o",
+        "--output=build\\release\\app.exe",
+        "src\\module\\file.cpp",
+        "/DNAME=value",
+        "x",
+        "\"C:\\Program Files\\Common Files\\lib.dll\"",
+        "\"say \\\"hello\\\" twice\"",
+        "a\\\\\\\\\"b c\"",
+        "\"\""
+    };
+    const unsigned nwords = quoted ? sizeof words / sizeof words[0] : 5;
+
+    std::basic_string<Ch> line;
+    const char *prog = "\"C:\\Program Files\\tool.exe\"";
+    line.assign(prog, prog + strlen(prog));
+
+    unsigned long seed = 12345;
+    while (line.size() < len)
+    {
+        seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+        const char *word = words[(seed >> 33) % nwords];
+        line += static_cast<Ch>(((seed >> 20) & 7) ? ' ' : '\t');
+        line.append(word, word + strlen(word));
+    }
+    return line;
+}
+
+
+typedef std::chrono::steady_clock Clock;
+
+struct Result
+{
+    double seconds;
+    std::size_t args;
+    std::size_t checksum;
+};
+
+
+template <class Ch, class Split>
+static Result run(Split split, const std::basic_string<Ch>& line,
+                  unsigned long rounds)
+{
+    std::vector<Ch> buf(line.size() + 1);
+    std::vector<Ch *> argv(line.size() / 2 + 2);
+    Result r = { 0, 0, 0 };
+
+    Clock::time_point start = Clock::now();
+    for (unsigned long k = 0; k < rounds; ++k)
+    {
+        r.args = split(line.data(), line.size(), buf.data(), argv.data(),
+                       argv.size());
+    }
+    r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (std::size_t i = 0; i < r.args && i < argv.size(); ++i)
+    {
+        for (const Ch *p = argv[i]; *p; ++p)
+        {
+            r.checksum = r.checksum * 31 + static_cast<std::size_t>(*p);
+        }
+        r.checksum = r.checksum * 31 + 1;
+    }
+    return r;
+}
+
+
+static void report(const char *label, const Result& r,
+                   std::size_t chars, unsigned long rounds)
+{
+    double n = static_cast<double>(chars) * rounds;
+    printf("%-29s %10.1f Mchars/s  %8.3f ns/char  (%lu arguments)\n",
+           label,
+           n / r.seconds / 1e6,
+           r.seconds * 1e9 / n,
+           (unsigned long)r.args);
+}
+
+
+/**
+ * quote the arguments of `line' back into a command line.
+ */
+template <class Ch>
+static bool benchQuote(const std::string& label,
+                       const std::basic_string<Ch>& line,
+                       unsigned long rounds)
+{
+    std::vector<Ch> buf(line.size() + 1);
+    std::vector<Ch *> argv(line.size() / 2 + 2);
+    std::size_t argc = cmdl_split_scalar<Ch>(line.data(), line.size(),
+                                             buf.data(), argv.data(),
+                                             argv.size());
+    const Ch *const *args = argv.data();
+
+    std::size_t size = cmdl_quote_size<Ch>(args, argc);
+    std::vector<Ch> out(size ? size : 1);
+    std::size_t len = 0;
+
+    Clock::time_point start = Clock::now();
+    for (unsigned long k = 0; k < rounds; ++k)
+    {
+        len = cmdl_quote<Ch>(args, argc, out.data(), out.size());
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    double n = static_cast<double>(len) * rounds;
+    printf("%-29s %10.1f Mchars/s  %8.1f ns/argument  (%lu arguments)\n",
+           (label + " cmdl_quote").c_str(),
+           n / seconds / 1e6,
+           seconds * 1e9 / (static_cast<double>(argc) * rounds),
+           (unsigned long)argc);
+
+    /* the quoted line must split into the same arguments. */
+    std::vector<Ch> buf2(len + 1);
+    std::vector<Ch *> argv2(argc + 1);
+    std::size_t argc2 = cmdl_split<Ch>(out.data(), len, buf2.data(),
+                                       argv2.data(), argv2.size());
+    bool same = (size == len + 1 && argc2 == argc);
+    for (std::size_t i = 0; same && i < argc; ++i)
+    {
+        same = (std::basic_string<Ch>(argv[i]) == argv2[i]);
+    }
+    if (!same)
+    {
+        fprintf(stderr,
+                "cmdline_bench: %s: the quoted line does not split back.\n",
+                label.c_str());
+    }
+    return same;
+}
+
+
+template <class Ch>
+static bool bench(const char *type, bool quoted,
+                  std::size_t len, unsigned long rounds)
+{
+    std::basic_string<Ch> line = makeLine<Ch>(len, quoted);
+    std::string label(type);
+    label += quoted ? " quoted" : " plain";
+
+    Result simd = run<Ch>(cmdl_split<Ch>, line, rounds);
+    report((label + " cmdl_split").c_str(), simd, line.size(), rounds);
+
+    Result scalar = run<Ch>(cmdl_split_scalar<Ch>, line, rounds);
+    report((label + " scalar").c_str(), scalar, line.size(), rounds);
+    printf("%-29s %10.2fx the scalar speed\n",
+           (label + " cmdl_split").c_str(), scalar.seconds / simd.seconds);
+
+    if (simd.args != scalar.args || simd.checksum != scalar.checksum)
+    {
+        fprintf(stderr,
+                "cmdline_bench: %s: the splitters disagree "
+                "(%lu and %lu arguments).\n",
+                label.c_str(),
+                (unsigned long)simd.args,
+                (unsigned long)scalar.args);
+        return false;
+    }
+    return benchQuote<Ch>(label, line, rounds);
+}
+
+
+static bool parseCount(const char *s, unsigned long& value)
+{
+    char *end = NULL;
+    value = strtoul(s, &end, 10);
+    return (*s && !*end);
+}
+
+
+int main(int argc, char **argv)
+{
+    unsigned long len = 1 << 20, rounds = 50;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        unsigned long value;
+        if (argv[i][0] != '-' || !argv[i][1] || argv[i][2] ||
+            i + 1 >= argc || !parseCount(argv[i + 1], value) || !value)
+        {
+            fprintf(stderr, "usage: cmdline_bench [-l length] [-r rounds]\n");
+            return EXIT_FAILURE;
+        }
+
+        switch (argv[i++][1])
+        {
+            case 'l': len = value; break;
+            case 'r': rounds = value; break;
+            default:  fprintf(stderr,
+                              "usage: cmdline_bench [-l length] [-r rounds]\n");
+                      return EXIT_FAILURE;
+        }
+    }
+
+    printf("command line of %lu characters x %lu rounds\n", len, rounds);
+
+    int status = EXIT_SUCCESS;
+    for (int quoted = 0; quoted < 2; ++quoted)
+    {
+        if (!bench<char>("char", quoted, len, rounds)) status = EXIT_FAILURE;
+        if (!bench<char16_t>("char16_t", quoted, len, rounds))
+        {
+            status = EXIT_FAILURE;
+        }
+    }
+    return status;
+}
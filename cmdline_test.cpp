@@ -0,0 +1,396 @@
+/**
+ * cmdline_test.cpp - regression tests for cmdline.cpp.
+ * checks cmdl_split on fixed cases of the CommandLineToArgvW rules, then
+ * compares it with cmdl_split_scalar on random command lines of
+ * characters that matter to the splitter, for char and char16_t.
+ * checks cmdl_quote on fixed cases, then quotes random argument lists and
+ * splits them back with both splitters, which must give the arguments.
+ *
+ * build: g++ -O2 -std=c++17 cmdline_test.cpp cmdline.cpp
+ *        (add -mavx2 to test the AVX2 scan instead of SSE2)
+ *
+ * SYNOPSIS: cmdline_test [-n cases] [-s seed]
+ *
+ * free to distribute under the GPL license.
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ */
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "cmdline.h"
+
+
+typedef std::vector<std::string> Args;
+
+static int failures = 0;
+
+
+static std::string show(const Args& args)
+{
+    std::string s("[");
+    for (std::size_t i = 0; i < args.size(); ++i)
+    {
+        if (i) s += ", ";
+        s += '<' + args[i] + '>';
+    }
+    return s + ']';
+}
+
+
+/**
+ * split `cmdl' with `split' (cmdl_split or cmdl_split_scalar).
+ */
+template <class Ch, class Split>
+static std::vector<std::basic_string<Ch> > splitWith(Split split,
+                                                     const std::basic_string<Ch>& cmdl,
+                                                     std::size_t maxargs,
+                                                     std::size_t& count)
+{
+    std::vector<Ch> buf(cmdl.size() + 1);
+    std::vector<Ch *> argv(maxargs + 1);
+    count = split(cmdl.data(), cmdl.size(), buf.data(), argv.data(), maxargs);
+
+    std::vector<std::basic_string<Ch> > args;
+    for (std::size_t i = 0; i < count && i < maxargs; ++i)
+    {
+        args.push_back(argv[i]);
+    }
+    return args;
+}
+
+
+/**
+ * check a fixed case on both splitters.
+ */
+static void expect(const char *cmdl, const Args& want)
+{
+    std::string line(cmdl);
+    std::size_t count, countScalar;
+    Args got = splitWith<char>(cmdl_split<char>, line, want.size() + 4, count);
+    Args gotScalar = splitWith<char>(cmdl_split_scalar<char>, line,
+                                     want.size() + 4, countScalar);
+
+    if (got != want || count != want.size() ||
+        gotScalar != want || countScalar != want.size())
+    {
+        fprintf(stderr, "cmdline_test: '%s': got %s and %s, expected %s.\n",
+                cmdl, show(got).c_str(), show(gotScalar).c_str(),
+                show(want).c_str());
+        ++failures;
+    }
+}
+
+
+static void fixedCases()
+{
+    /* the program name: blanks end it, quotes only delimit it. */
+    expect("prog a b", Args{ "prog", "a", "b" });
+    expect(" a b", Args{ "", "a", "b" });
+    expect("\t a", Args{ "", "a" });
+    expect("\"C:\\Program Files\\x.exe\" a", Args{ "C:\\Program Files\\x.exe", "a" });
+    expect("\"pro\"g a", Args{ "pro", "g", "a" });
+    expect("a\\\"b c", Args{ "a\\\"b", "c" });
+
+    /* blanks outside quotes separate, runs of them count once. */
+    expect("prog  a\t\tb  ", Args{ "prog", "a", "b" });
+    expect("prog \"a b\"c d", Args{ "prog", "a bc", "d" });
+    expect("prog \"\" x", Args{ "prog", "", "x" });
+
+    /* backslashes are literal unless a double quote follows. */
+    expect("prog a\\\\\\b d\"e f\"g h", Args{ "prog", "a\\\\\\b", "de fg", "h" });
+    expect("prog a\\\\b", Args{ "prog", "a\\\\b" });
+
+    /* 2n backslashes and a quote: n backslashes, the quote delimits. */
+    expect("prog a\\\\\"b c\" d", Args{ "prog", "a\\b c", "d" });
+    expect("prog a\\\\\\\\\"b c\" d e", Args{ "prog", "a\\\\b c", "d", "e" });
+
+    /* 2n+1 backslashes and a quote: n backslashes and a literal quote. */
+    expect("prog a\\\"b c d", Args{ "prog", "a\"b", "c", "d" });
+    expect("prog a\\\\\\\"b c d", Args{ "prog", "a\\\"b", "c", "d" });
+
+    /* "" inside quotes is a literal quote and ends the quoted part. */
+    expect("prog a\"b\"\" c d", Args{ "prog", "ab\"", "c", "d" });
+    expect("prog \"a\"\"\"b\"", Args{ "prog", "a\"b" });
+    expect("prog \"\"\"\"\"\"", Args{ "prog", "\"\"" });
+}
+
+
+/**
+ * quote `args' with both forms of cmdl_quote, which must agree with each
+ * other and with cmdl_quote_size. returns false if they cannot be quoted.
+ */
+template <class Ch>
+static bool quote(const std::vector<std::basic_string<Ch> >& args,
+                  std::basic_string<Ch>& line)
+{
+    std::vector<const Ch *> argv;
+    for (std::size_t i = 0; i < args.size(); ++i) argv.push_back(args[i].c_str());
+
+    std::size_t size = cmdl_quote_size<Ch>(argv.data(), argv.size());
+    Ch *quoted = cmdl_quote<Ch>(argv.data(), argv.size());
+    if (size == 0 || quoted == NULL)
+    {
+        if (size != 0 || quoted != NULL)
+        {
+            fprintf(stderr, "cmdline_test: cmdl_quote_size and cmdl_quote "
+                    "disagree on whether %lu arguments can be quoted.\n",
+                    (unsigned long)args.size());
+            ++failures;
+        }
+        free(quoted);
+        return false;
+    }
+    line = quoted;
+    free(quoted);
+
+    /* the exact size fits, one less does not. */
+    std::vector<Ch> buf(size);
+    std::size_t len = cmdl_quote<Ch>(argv.data(), argv.size(), buf.data(), size);
+    std::size_t tight = size > 1
+                      ? cmdl_quote<Ch>(argv.data(), argv.size(), buf.data(), size - 1)
+                      : 0;
+    if (size != line.size() + 1 || len != line.size() || tight != 0 ||
+        std::basic_string<Ch>(buf.data(), len) != line)
+    {
+        fprintf(stderr, "cmdline_test: %lu arguments: size %lu, length %lu, "
+                "quoted into the buffer as %lu characters (%lu when short).\n",
+                (unsigned long)args.size(), (unsigned long)size,
+                (unsigned long)line.size(), (unsigned long)len,
+                (unsigned long)tight);
+        ++failures;
+    }
+    return true;
+}
+
+
+/**
+ * quote `args' and split the line back with both splitters.
+ */
+template <class Ch>
+static bool roundTrip(const std::vector<std::basic_string<Ch> >& args)
+{
+    std::basic_string<Ch> line;
+    if (!quote<Ch>(args, line)) return false;
+
+    std::size_t count, countScalar;
+    std::vector<std::basic_string<Ch> > got =
+        splitWith<Ch>(cmdl_split<Ch>, line, args.size() + 2, count);
+    std::vector<std::basic_string<Ch> > gotScalar =
+        splitWith<Ch>(cmdl_split_scalar<Ch>, line, args.size() + 2, countScalar);
+
+    return (got == args && gotScalar == args &&
+            count == args.size() && countScalar == args.size());
+}
+
+
+static void expectQuoted(const Args& args, const char *want)
+{
+    std::string line;
+    bool quoted = quote<char>(args, line);
+
+    if (want == NULL ? quoted : (!quoted || line != want))
+    {
+        fprintf(stderr, "cmdline_test: quoting %s: got '%s', expected '%s'.\n",
+                show(args).c_str(), quoted ? line.c_str() : "(cannot quote)",
+                want ? want : "(cannot quote)");
+        ++failures;
+    }
+    else if (want && !roundTrip<char>(args))
+    {
+        fprintf(stderr, "cmdline_test: '%s' does not split back into %s.\n",
+                want, show(args).c_str());
+        ++failures;
+    }
+}
+
+
+static void fixedQuotes()
+{
+    /* nothing to quote, an empty list, an empty argument. */
+    expectQuoted(Args{ "prog", "a", "b" }, "prog a b");
+    expectQuoted(Args{}, "");
+    expectQuoted(Args{ "prog", "" }, "prog \"\"");
+
+    /* quotes are escaped; backslashes only before a quote are doubled. */
+    expectQuoted(Args{ "prog", "a\"b" }, "prog \"a\\\"b\"");
+    expectQuoted(Args{ "prog", "a\\\\\"b" }, "prog \"a\\\\\\\\\\\"b\"");
+    expectQuoted(Args{ "prog", "a\\" }, "prog a\\");
+
+    /* a trailing backslash run is doubled before the closing quote. */
+    expectQuoted(Args{ "prog", "a b\\" }, "prog \"a b\\\\\"");
+    expectQuoted(Args{ "prog", "a\tb\\\\" }, "prog \"a\tb\\\\\\\\\"");
+
+    /* the program name is quoted as it is, so it cannot hold a quote
+       once it has to be quoted. */
+    expectQuoted(Args{ "C:\\Program Files\\x.exe", "a" },
+                 "\"C:\\Program Files\\x.exe\" a");
+    expectQuoted(Args{ "" }, "\"\"");
+    expectQuoted(Args{ "a\"b", "c" }, "a\"b c");
+    expectQuoted(Args{ "\"C:\\x y\"", "a" }, NULL);
+    expectQuoted(Args{ "a b\"c" }, NULL);
+    expectQuoted(Args{ "\"prog" }, NULL);
+}
+
+
+/**
+ * a random command line of characters that matter to the splitter, with
+ * long runs now and then so that they cross the 64-character blocks.
+ * for char16_t, characters whose low byte is a quote, a backslash or a
+ * blank must not pass for them.
+ */
+template <class Ch>
+static std::basic_string<Ch> randomLine(unsigned long& seed)
+{
+    static const unsigned Alphabet[] =
+    {
+        'a', 'b', ' ', '\t', '"', '\\', '\\', '"', 0xe9, 0x4e22, 0x225c, 0x0920
+    };
+    const unsigned letters = sizeof(Ch) == 1 ? 9 : 12;
+
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    std::size_t len = static_cast<std::size_t>(seed >> 33) % 300;
+
+    std::basic_string<Ch> line;
+    while (line.size() < len)
+    {
+        seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+        Ch c = static_cast<Ch>(Alphabet[(seed >> 33) % letters]);
+        std::size_t run = ((seed >> 20) & 15) == 0 ? (seed >> 40) % 80 + 1 : 1;
+        line.append(run, c);
+    }
+    line.resize(len);
+    return line;
+}
+
+
+/**
+ * a random argument list. the program name never holds a double quote,
+ * so that it can always be quoted.
+ */
+template <class Ch>
+static std::vector<std::basic_string<Ch> > randomArgs(unsigned long& seed)
+{
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    std::size_t argc = static_cast<std::size_t>(seed >> 33) % 8;
+
+    std::vector<std::basic_string<Ch> > args;
+    for (std::size_t i = 0; i < argc; ++i)
+    {
+        std::basic_string<Ch> arg = randomLine<Ch>(seed);
+        arg.resize(arg.size() % 40);
+        if (i == 0)
+        {
+            for (std::size_t j = 0; j < arg.size(); ++j)
+            {
+                if (arg[j] == '"') arg[j] = '\\';
+            }
+        }
+        args.push_back(arg);
+    }
+    return args;
+}
+
+
+template <class Ch>
+static void fuzzQuote(const char *label, unsigned long cases, unsigned long seed)
+{
+    unsigned long bad = 0;
+    for (unsigned long k = 0; k < cases; ++k)
+    {
+        std::vector<std::basic_string<Ch> > args = randomArgs<Ch>(seed);
+        if (!roundTrip<Ch>(args) && bad++ < 5)
+        {
+            fprintf(stderr, "cmdline_test: %s: quoting case %lu "
+                    "(%lu arguments) does not split back.\n",
+                    label, k, (unsigned long)args.size());
+        }
+    }
+
+    printf("%-10s %lu quoted lists, %lu mismatches\n", label, cases, bad);
+    if (bad) ++failures;
+}
+
+
+template <class Ch>
+static void fuzz(const char *label, unsigned long cases, unsigned long seed)
+{
+    unsigned long bad = 0;
+    for (unsigned long k = 0; k < cases; ++k)
+    {
+        std::basic_string<Ch> line = randomLine<Ch>(seed);
+        std::size_t maxargs = (k & 7) ? line.size() + 2 : k % 5;
+
+        std::size_t count, countScalar;
+        std::vector<std::basic_string<Ch> > got =
+            splitWith<Ch>(cmdl_split<Ch>, line, maxargs, count);
+        std::vector<std::basic_string<Ch> > want =
+            splitWith<Ch>(cmdl_split_scalar<Ch>, line, maxargs, countScalar);
+
+        if (got != want || count != countScalar)
+        {
+            if (bad++ < 5)
+            {
+                fprintf(stderr, "cmdline_test: %s: case %lu (%lu characters): "
+                        "%lu arguments, expected %lu.\n",
+                        label, k, (unsigned long)line.size(),
+                        (unsigned long)count, (unsigned long)countScalar);
+            }
+        }
+    }
+
+    printf("%-10s %lu cases, %lu mismatches\n", label, cases, bad);
+    if (bad) ++failures;
+}
+
+
+static bool parseCount(const char *s, unsigned long& value)
+{
+    char *end = NULL;
+    value = strtoul(s, &end, 10);
+    return (*s && !*end);
+}
+
+
+int main(int argc, char **argv)
+{
+    unsigned long cases = 100000, seed = 12345;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        unsigned long value;
+        if (argv[i][0] != '-' || !argv[i][1] || argv[i][2] ||
+            i + 1 >= argc || !parseCount(argv[i + 1], value))
+        {
+            fprintf(stderr, "usage: cmdline_test [-n cases] [-s seed]\n");
+            return EXIT_FAILURE;
+        }
+
+        switch (argv[i++][1])
+        {
+            case 'n': cases = value; break;
+            case 's': seed = value; break;
+            default:  fprintf(stderr, "usage: cmdline_test [-n cases] [-s seed]\n");
+                      return EXIT_FAILURE;
+        }
+    }
+
+    fixedCases();
+    fuzz<char>("char", cases, seed);
+    fuzz<char16_t>("char16_t", cases, seed);
+
+    fixedQuotes();
+    fuzzQuote<char>("char", cases, seed);
+    fuzzQuote<char16_t>("char16_t", cases, seed);
+
+    if (failures)
+    {
+        fprintf(stderr, "cmdline_test: %d failures.\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("cmdline_test: all passed.\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+
+/**
+ * getopt_r - command option parsing
+ * free to distribute under the GPL license.
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ * see http://www.opengroup.org/onlinepubs/000095399/functions/getopt.html
+ * for the specification of getopt, the non-reentrant counterpart.
+ *
+ * the C entry points of getopt::parser (getopt.hpp). the option string
+ * comes at run time here, so its table is built by the constexpr code of
+ * make_spec running as ordinary code, once per option string, and kept
+ * in the caller's opt_st with the parser.
+ */
+
+#include <new>
+#include <stdexcept>
+#include "getopt.h"
+#include "getopt.hpp"
+
+
+namespace
+{
+
+struct State
+{
+    const char *optstring;  /* the one `spec' was built from, or NULL */
+    bool valid;             /* make_spec took it */
+    getopt::spec<0> spec;
+    getopt::parser<0> parser;
+
+    State()
+        : optstring(NULL),
+          valid(false),
+          spec(),
+          parser(spec)
+    {
+    }
+};
+
+static_assert(sizeof(State) <= sizeof(((opt_st *)0)->__state),
+              "getopt: opt_st too small for the parser");
+static_assert(alignof(State) <= alignof(opt_st),
+              "getopt: opt_st not aligned for the parser");
+
+inline State *state(opt_st *opt)
+{
+    return reinterpret_cast<State *>(opt->__state.bytes);
+}
+
+inline const State *state(const opt_st *opt)
+{
+    return reinterpret_cast<const State *>(opt->__state.bytes);
+}
+
+}   // namespace
+
+
+const char *const optarg(const opt_st *const opt) { return state(opt)->parser.optarg(); }
+const int optind(const opt_st *const opt) { return state(opt)->parser.optind(); }
+const int optopt(const opt_st *const opt) { return state(opt)->parser.optopt(); }
+
+void opt_reset(opt_st *opt)
+{
+    /* State is trivially destructible: a new one replaces the old. */
+    new (opt->__state.bytes) State();
+}
+
+void opt_init(opt_st **popt, void* (*alloc)(size_t))
+{
+    *popt = (opt_st *)alloc(sizeof(opt_st));
+    assert(*popt);
+    opt_reset(*popt);
+}
+
+
+int
+getopt_r(int argc,
+         char *const *argv,
+         const char *optstring,
+         opt_st *opt)
+{
+    State *s = state(opt);
+    if (optstring != s->optstring)
+    {
+        /* the parser holds a reference to `spec', which stays in place. */
+        try
+        {
+            s->spec = getopt::detail::build<0>(optstring, NULL);
+            s->valid = true;
+        }
+        catch (const std::logic_error&)
+        {
+            s->valid = false;
+        }
+        s->optstring = optstring;
+    }
+    if (!s->valid) return (-1);
+
+    return s->parser(argc, argv);
+}
@@ -19,15 +19,41 @@ extern "C" {
 #include <stdlib.h>
 #include <string.h>
 
-struct opt_st;
-typedef struct opt_st opt_st;
+/**
+ * the state of a parse: getopt::parser (getopt.hpp) and the table of the
+ * option string it was last given, kept in place. it may live anywhere,
+ * on the stack included; opt_reset() starts it.
+ */
+typedef struct opt_st
+{
+    union
+    {
+        void *align;
+        unsigned char bytes[512];
+    } __state;
+} opt_st;
 
 const char *const optarg(const opt_st *const opt);
 const int optind(const opt_st *const opt);
 const int optopt(const opt_st *const opt);
 
+/**
+ * start a parse at argv[1] with the state in `opt'.
+ */
+void opt_reset(opt_st *opt);
+
+/**
+ * start a parse with state allocated by `alloc', for callers that keep
+ * it on the heap; opt_reset() needs no allocation.
+ */
 void opt_init(opt_st **popt, void* (*alloc)(size_t));
 
+/**
+ * a thin wrapper over getopt::parser: the table of `optstring' is built
+ * at the first call and again only if another option string is given.
+ * an option string getopt::make_spec rejects (a character other than a
+ * letter or a digit, or one given twice) gives -1 at once.
+ */
 int getopt_r(int argc, char *const *argv, const char *optstring, opt_st *opt);
 
 #if defined(__cplusplus)
@@ -0,0 +1,365 @@
+#ifndef GETOPT_HPP_INCLUDED
+#define GETOPT_HPP_INCLUDED
+
+/**
+ * getopt.hpp - command option parsing, specialized at compile time.
+ * free to distribute under the GPL license.
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ *
+ * the C++ counterpart of getopt_r (getopt.h), with the same results,
+ * plus "--name" and "--name=value" long options:
+ *
+ *   static constexpr getopt::longopt longopts[] =
+ *   {
+ *       { "manifest", getopt::required_argument, 'M' },
+ *   };
+ *   static constexpr auto spec = getopt::make_spec(":acr:", longopts);
+ *
+ *   getopt::parser opt(spec);
+ *   for (int c; (c = opt(argc, argv)) != -1; ) ...
+ *
+ * make_spec checks the option string while compiling (a mistake fails the
+ * build) and turns it into a table indexed by the option character;
+ * long options are found through a perfect hash, also built while compiling.
+ * the parser keeps its state in itself, so nothing is allocated.
+ *
+ * getopt_r (getopt.h) is a thin C wrapper over this parser, for C
+ * callers; nothing in this tree calls it any more. getopt_bench.cpp
+ * times the two on long argument vectors.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+
+namespace getopt
+{
+
+enum
+{
+    no_argument = 0,
+    required_argument = 1
+};
+
+struct longopt
+{
+    const char *name;
+    int has_arg;
+    int val;        /* returned when the option is found */
+};
+
+
+/**
+ * hash table size for `n' long options: a power of two, at least 2n.
+ */
+constexpr std::size_t slots(std::size_t n)
+{
+    std::size_t m = 1;
+    while (m < 2 * n) m *= 2;
+    return m;
+}
+
+/**
+ * FNV-1a over [s, end) (or up to the first NUL if end is NULL), seeded,
+ * with a final mix so that the low bits depend on every bit of the seed.
+ */
+constexpr std::uint32_t hash(const char *s, const char *end, std::uint32_t seed)
+{
+    std::uint32_t h = 2166136261u ^ seed;
+    for (; end ? s != end : *s != '\0'; ++s)
+    {
+        h = (h ^ static_cast<unsigned char>(*s)) * 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    return h;
+}
+
+constexpr bool equal(const char *a, const char *b)
+{
+    while (*a && *a == *b)
+    {
+        ++a;
+        ++b;
+    }
+    return (*a == *b);
+}
+
+
+template <std::size_t N>
+struct spec
+{
+    static constexpr std::size_t size = N;
+    static constexpr std::size_t mask = slots(N) - 1;
+
+    enum { none = 0, flag = 1, arg = 2 };
+
+    std::array<unsigned char, 256> kind;    /* by option character */
+    bool colon;     /* a leading ':' (report a missing operand as ':') */
+    std::array<longopt, N> longs;
+    std::uint32_t seed;
+    std::array<unsigned char, slots(N)> slot;   /* 1 + index, or 0 */
+
+    /**
+     * find the long option named [name, end), or NULL.
+     */
+    const longopt *find(const char *name, const char *end) const
+    {
+        if constexpr (N == 0) return nullptr;
+
+        unsigned char i = slot[hash(name, end, seed) & mask];
+        if (i == 0) return nullptr;
+
+        const char *p = longs[i - 1].name;
+        for (; name != end && *p == *name; ++p, ++name) {}
+        return (name == end && *p == '\0') ? &longs[i - 1] : nullptr;
+    }
+};
+
+
+namespace detail
+{
+
+constexpr bool isoptchar(char c)
+{
+    return ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+            (c >= '0' && c <= '9'));
+}
+
+template <std::size_t N>
+constexpr spec<N> build(const char *optstring, const longopt *longs)
+{
+    spec<N> s = {};
+
+    const char *p = optstring;
+    s.colon = (*p == ':');
+    if (s.colon) ++p;
+
+    for (; *p; ++p)
+    {
+        if (!isoptchar(*p))
+        {
+            throw std::logic_error("getopt: option characters must be alphanumeric");
+        }
+
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (s.kind[c] != spec<N>::none)
+        {
+            throw std::logic_error("getopt: option character given twice");
+        }
+
+        s.kind[c] = spec<N>::flag;
+        if (p[1] == ':')
+        {
+            s.kind[c] = spec<N>::arg;
+            ++p;
+        }
+    }
+
+    for (std::size_t i = 0; i < N; ++i)
+    {
+        const char *name = longs[i].name;
+        if (!name || !*name)
+        {
+            throw std::logic_error("getopt: empty long option name");
+        }
+        for (const char *q = name; *q; ++q)
+        {
+            if (*q == '=') throw std::logic_error("getopt: '=' in long option name");
+        }
+        for (std::size_t j = 0; j < i; ++j)
+        {
+            if (equal(longs[j].name, name))
+            {
+                throw std::logic_error("getopt: long option given twice");
+            }
+        }
+        if (longs[i].has_arg != no_argument && longs[i].has_arg != required_argument)
+        {
+            throw std::logic_error("getopt: bad has_arg of long option");
+        }
+        s.longs[i] = longs[i];
+    }
+
+    /* try seeds until every name lands in a slot of its own. */
+    for (std::uint32_t seed = 0; seed < 65536; ++seed)
+    {
+        std::array<unsigned char, slots(N)> slot = {};
+        bool collision = false;
+        for (std::size_t i = 0; i < N && !collision; ++i)
+        {
+            std::size_t h = hash(longs[i].name, nullptr, seed) & spec<N>::mask;
+            if (slot[h]) collision = true;
+            slot[h] = static_cast<unsigned char>(i + 1);
+        }
+
+        if (!collision)
+        {
+            s.seed = seed;
+            s.slot = slot;
+            return s;
+        }
+    }
+
+    throw std::logic_error("getopt: no perfect hash for the long options");
+}
+
+}   // namespace detail
+
+
+template <std::size_t N>
+constexpr spec<N> make_spec(const char *optstring, const longopt (&longs)[N])
+{
+    static_assert(N < 256, "getopt: too many long options");
+    return detail::build<N>(optstring, longs);
+}
+
+constexpr spec<0> make_spec(const char *optstring)
+{
+    return detail::build<0>(optstring, nullptr);
+}
+
+
+template <std::size_t N>
+class parser
+{
+public:
+    explicit parser(const spec<N>& s)
+        : spec_(s),
+          optarg_(nullptr),
+          longopt_(nullptr),
+          optind_(1),
+          optopt_(0),
+          i_(1)
+    {
+    }
+
+    const char *optarg() const { return optarg_; }
+    int optind() const { return optind_; }
+    int optopt() const { return optopt_; }
+
+    /**
+     * the long option (as given, with any "=value") behind the last '?'
+     * or ':', or NULL if it was a short one.
+     */
+    const char *longopt() const { return longopt_; }
+
+    int operator()(int argc, char *const *argv)
+    {
+        longopt_ = nullptr;
+        if (optind_ >= argc) return (-1);
+
+        const char *arg = argv[optind_];
+        if (!arg || arg[0] != '-' || arg[1] == '\0') return (-1);
+
+        if (arg[1] == '-' && i_ == 1)
+        {
+            if (arg[2] == '\0')
+            {
+                ++optind_;
+                return (-1);
+            }
+            return parselong(argc, argv, arg);
+        }
+
+        unsigned char c = static_cast<unsigned char>(arg[i_]);
+        switch (spec_.kind[c])
+        {
+            case spec<N>::flag:
+                step(arg);
+                return c;
+
+            case spec<N>::arg:
+                if (arg[i_ + 1] != '\0')
+                {
+                    optarg_ = &arg[i_ + 1];
+                }
+                else
+                {
+                    if (++optind_ >= argc || !argv[optind_])
+                    {
+                        optopt_ = c;
+                        i_ = 1;
+                        return (spec_.colon ? ':' : '?');
+                    }
+                    optarg_ = argv[optind_];
+                }
+                ++optind_;
+                i_ = 1;
+                return c;
+
+            default:
+                /* skip it, so that a caller may go on parsing. */
+                optopt_ = c;
+                step(arg);
+                return '?';
+        }
+    }
+
+private:
+    /**
+     * move past the short option at arg[i_].
+     */
+    void step(const char *arg)
+    {
+        if (arg[i_ + 1] != '\0')
+        {
+            ++i_;
+        }
+        else
+        {
+            ++optind_;
+            i_ = 1;
+        }
+    }
+
+    int parselong(int argc, char *const *argv, const char *arg)
+    {
+        const char *name = arg + 2;
+        const char *end = name;
+        while (*end && *end != '=') ++end;
+
+        const getopt::longopt *opt = spec_.find(name, end);
+        ++optind_;
+        optopt_ = 0;
+
+        if (!opt || (opt->has_arg == no_argument && *end == '='))
+        {
+            longopt_ = arg;
+            return '?';
+        }
+
+        if (opt->has_arg == required_argument)
+        {
+            if (*end == '=')
+            {
+                optarg_ = end + 1;
+            }
+            else if (optind_ < argc && argv[optind_])
+            {
+                optarg_ = argv[optind_++];
+            }
+            else
+            {
+                longopt_ = arg;
+                return (spec_.colon ? ':' : '?');
+            }
+        }
+
+        return opt->val;
+    }
+
+    const spec<N>& spec_;
+    const char *optarg_;
+    const char *longopt_;
+    int optind_;
+    int optopt_;
+    int i_;     /* position within a cluster of short options */
+};
+
+}   // namespace getopt
+
+#endif  /* GETOPT_HPP_INCLUDED */
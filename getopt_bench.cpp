@@ -0,0 +1,246 @@
+/**
+ * getopt_bench.cpp - parse cost of very long argument vectors.
+ * times getopt::parser (getopt.hpp) against getopt_r (getopt.cpp), the
+ * C wrapper over it, on the same synthetic vector of short options,
+ * clusters and option arguments, then getopt::parser alone on long
+ * options, which getopt_r lacks. both must return the same options and
+ * arguments; the difference in time is the cost of the wrapper.
+ *
+ * build: g++ -O2 -std=c++17 getopt_bench.cpp getopt.cpp
+ *
+ * SYNOPSIS: getopt_bench [-n args] [-r rounds]
+ *
+ * free to distribute under the GPL license.
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ */
+
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "getopt.h"
+#include "getopt.hpp"
+
+
+static const char OptString[] = ":acmr:t:";
+
+static constexpr getopt::longopt longopts[] =
+{
+    { "access", getopt::no_argument, 'a' },
+    { "no-create", getopt::no_argument, 'c' },
+    { "modify", getopt::no_argument, 'm' },
+    { "reference", getopt::required_argument, 'r' },
+    { "time", getopt::required_argument, 't' },
+    { "from0", getopt::required_argument, 'F' },
+    { "stdin0", getopt::no_argument, 'S' },
+    { "manifest", getopt::required_argument, 'M' }
+};
+
+static constexpr auto optspec = getopt::make_spec(OptString, longopts);
+
+
+/**
+ * an argument vector and the storage of its strings.
+ */
+struct Args
+{
+    std::vector<std::string> strings;
+    std::vector<char *> argv;   /* NULL-terminated, as getopt_r needs */
+
+    int argc() const { return static_cast<int>(argv.size() - 1); }
+
+    void finish()
+    {
+        argv.clear();
+        for (std::size_t i = 0; i < strings.size(); ++i)
+        {
+            argv.push_back(&strings[i][0]);
+        }
+        argv.push_back(NULL);
+    }
+};
+
+
+/**
+ * `n' arguments after the program name: a deterministic mix of single
+ * options, clusters, attached and separate option arguments, ended by
+ * one operand. with `longs', the options are spelled as long options.
+ */
+static void makeArgs(Args& args, unsigned long n, bool longs)
+{
+    static const char *const shorts[] = { "-a", "-acm", "-r", "-tnow", "-mc" };
+    static const char *const names[] =
+    {
+        "--access", "--modify", "--reference", "--time=now", "--manifest=m"
+    };
+
+    args.strings.clear();
+    args.strings.push_back("prog");
+
+    unsigned long seed = 12345;
+    while (args.strings.size() < n)
+    {
+        seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+        unsigned k = static_cast<unsigned>(seed >> 33) % 5;
+        args.strings.push_back(longs ? names[k] : shorts[k]);
+        if (k == 2) args.strings.push_back("file");
+    }
+    args.strings.push_back("operand");
+    args.finish();
+}
+
+
+/**
+ * a checksum of what a parser returned, to compare the two.
+ */
+struct Result
+{
+    double seconds;
+    unsigned long options;
+    unsigned long sum;
+    int optind;
+};
+
+static void add(Result& r, int c, const char *optarg)
+{
+    ++r.options;
+    r.sum = r.sum * 31 + static_cast<unsigned>(c);
+    if (optarg) r.sum += strlen(optarg);
+}
+
+
+typedef std::chrono::steady_clock Clock;
+
+
+static Result runParser(const Args& args, unsigned long rounds)
+{
+    Result r = { 0, 0, 0, 0 };
+    int argc = args.argc();
+    char *const *argv = args.argv.data();
+
+    Clock::time_point start = Clock::now();
+    for (unsigned long k = 0; k < rounds; ++k)
+    {
+        getopt::parser opt(optspec);
+        for (int c; (c = opt(argc, argv)) != -1; )
+        {
+            add(r, c, (c == 'r' || c == 't' || c == 'M') ? opt.optarg() : NULL);
+        }
+        r.optind = opt.optind();
+    }
+    r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return r;
+}
+
+
+static Result runGetoptR(const Args& args, unsigned long rounds)
+{
+    Result r = { 0, 0, 0, 0 };
+    int argc = args.argc();
+    char *const *argv = args.argv.data();
+
+    Clock::time_point start = Clock::now();
+    for (unsigned long k = 0; k < rounds; ++k)
+    {
+        opt_st opt;
+        opt_reset(&opt);
+        for (int c; (c = getopt_r(argc, argv, OptString, &opt)) != -1; )
+        {
+            add(r, c, (c == 'r' || c == 't') ? optarg(&opt) : NULL);
+        }
+        r.optind = optind(&opt);
+    }
+    r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return r;
+}
+
+
+static void report(const char *label, const Result& r, unsigned long args)
+{
+    printf("%-16s %8.2f ns/argument  %12.0f arguments/s  (%lu options)\n",
+           label,
+           r.seconds * 1e9 / args,
+           args / r.seconds,
+           r.options);
+}
+
+
+static void usage()
+{
+    fprintf(stderr, "usage: getopt_bench [-n args] [-r rounds]\n");
+}
+
+
+static bool parseCount(const char *s, unsigned long& value)
+{
+    char *end = NULL;
+    value = strtoul(s, &end, 10);
+    return (*s && !*end);
+}
+
+
+int main(int argc, char **argv)
+{
+    unsigned long n = 1000000, rounds = 20;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        unsigned long value;
+        if (argv[i][0] != '-' || !argv[i][1] || argv[i][2] ||
+            i + 1 >= argc || !parseCount(argv[i + 1], value) || !value)
+        {
+            usage();
+            return EXIT_FAILURE;
+        }
+
+        switch (argv[i++][1])
+        {
+            case 'n': n = value; break;
+            case 'r': rounds = value; break;
+            default:  usage();
+                      return EXIT_FAILURE;
+        }
+    }
+
+    int status = EXIT_SUCCESS;
+    Args args;
+
+    makeArgs(args, n, false);
+    unsigned long total = static_cast<unsigned long>(args.argc() - 1) * rounds;
+    printf("%d arguments x %lu rounds\n", args.argc() - 1, rounds);
+
+    Result parsed = runParser(args, rounds);
+    report("getopt::parser", parsed, total);
+
+    Result parsedR = runGetoptR(args, rounds);
+    report("getopt_r", parsedR, total);
+
+    if (parsed.options != parsedR.options || parsed.sum != parsedR.sum ||
+        parsed.optind != parsedR.optind || parsed.optind != args.argc() - 1)
+    {
+        fprintf(stderr,
+                "getopt_bench: the parsers disagree: %lu and %lu options, "
+                "operands at %d and %d.\n",
+                parsed.options, parsedR.options, parsed.optind, parsedR.optind);
+        status = EXIT_FAILURE;
+    }
+
+    makeArgs(args, n, true);
+    total = static_cast<unsigned long>(args.argc() - 1) * rounds;
+
+    Result parsedLong = runParser(args, rounds);
+    report("long options", parsedLong, total);
+
+    if (parsedLong.optind != args.argc() - 1)
+    {
+        fprintf(stderr,
+                "getopt_bench: long options: operands at %d, expected %d.\n",
+                parsedLong.optind, args.argc() - 1);
+        status = EXIT_FAILURE;
+    }
+
+    return status;
+}
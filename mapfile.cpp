@@ -0,0 +1,147 @@
+/**
+ * mapfile.cpp - map a whole file into memory for reading.
+ * a portable C++ implementation for Microsoft Windows and GNU/Linux.
+ *
+ * free to distribute under the GPL license.
+ * if you have not received a copy of the license along with the code,
+ * confer to http://www.gnu.org/licenses/gpl.html
+ *
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ */
+
+
+#include "mapfile.h"
+
+#if defined(_WIN32)
+#   include <windows.h>
+#else
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <errno.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+
+#if defined(_WIN32)
+
+bool map_file(const char *path, mapfile_st& map, bool writable)
+{
+    map.data = NULL;
+    map.size = 0;
+    map.handle = NULL;
+
+    HANDLE hFile = CreateFileA(path,
+                               GENERIC_READ,
+                               FILE_SHARE_READ,
+                               NULL,
+                               OPEN_EXISTING,
+                               FILE_FLAG_SEQUENTIAL_SCAN,
+                               NULL);
+    if (hFile == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(hFile, &size))
+    {
+        CloseHandle(hFile);
+        return false;
+    }
+    if (size.QuadPart == 0)
+    {
+        CloseHandle(hFile);
+        return true;
+    }
+
+    HANDLE hMap = CreateFileMappingA(hFile,
+                                     NULL,
+                                     writable ? PAGE_WRITECOPY : PAGE_READONLY,
+                                     0,
+                                     0,
+                                     NULL);
+    CloseHandle(hFile);
+    if (hMap == NULL) return false;
+
+    void *data = MapViewOfFile(hMap,
+                               writable ? FILE_MAP_COPY : FILE_MAP_READ,
+                               0,
+                               0,
+                               0);
+    if (data == NULL)
+    {
+        CloseHandle(hMap);
+        return false;
+    }
+
+    map.data = static_cast<char *>(data);
+    map.size = (size_t)size.QuadPart;
+    map.handle = hMap;
+    return true;
+}
+
+
+void unmap_file(mapfile_st& map)
+{
+    if (map.data) UnmapViewOfFile(map.data);
+    if (map.handle) CloseHandle(map.handle);
+    map.data = NULL;
+    map.size = 0;
+    map.handle = NULL;
+}
+
+#else
+
+bool map_file(const char *path, mapfile_st& map, bool writable)
+{
+    map.data = NULL;
+    map.size = 0;
+    map.handle = NULL;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat buf;
+    if (fstat(fd, &buf))
+    {
+        int err = errno;
+        close(fd);
+        errno = err;
+        return false;
+    }
+    if (buf.st_size == 0)
+    {
+        close(fd);
+        return true;
+    }
+
+    void *data = mmap(NULL,
+                      (size_t)buf.st_size,
+                      writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                      MAP_PRIVATE,
+                      fd,
+                      0);
+    int err = errno;
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        errno = err;
+        return false;
+    }
+
+#if defined(POSIX_MADV_SEQUENTIAL)
+    posix_madvise(data, (size_t)buf.st_size, POSIX_MADV_SEQUENTIAL);
+#endif
+
+    map.data = static_cast<char *>(data);
+    map.size = (size_t)buf.st_size;
+    return true;
+}
+
+
+void unmap_file(mapfile_st& map)
+{
+    if (map.data) munmap(map.data, map.size);
+    map.data = NULL;
+    map.size = 0;
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef MAPFILE_H_INCLUDED
+#define MAPFILE_H_INCLUDED
+
+/**
+ * mapfile - map a whole file into memory for reading.
+ * a copy-on-write mapping may also be written to; the file is not changed.
+ * free to distribute under the GPL license.
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ */
+
+#include <stddef.h>
+
+
+typedef struct
+{
+    char *data;
+    size_t size;
+    void *handle;   /* the file mapping object on Windows */
+} mapfile_st;
+
+
+/**
+ * map the file `path', copy-on-write if `writable';
+ * an empty file maps to { NULL, 0 }.
+ * returns false with errno (or the last Windows error) set on failure.
+ */
+bool map_file(const char *path, mapfile_st& map, bool writable = false);
+
+void unmap_file(mapfile_st& map);
+
+#endif  /* MAPFILE_H_INCLUDED */
@@ -0,0 +1,297 @@
+/**
+ * operands.cpp - the operands left after option parsing, read lazily.
+ * a portable C++ implementation for Microsoft Windows and GNU/Linux.
+ *
+ * free to distribute under the GPL license.
+ * if you have not received a copy of the license along with the code,
+ * confer to http://www.gnu.org/licenses/gpl.html
+ *
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ */
+
+
+#include <errno.h>
+#include <string.h>
+#include "operands.h"
+
+#if defined(_WIN32)
+#   include <fcntl.h>
+#   include <io.h>
+#endif
+
+
+namespace getopt
+{
+
+static inline bool isblank_(char c)
+{
+    return (c == ' ' || c == '\t' || c == '\n' ||
+            c == '\r' || c == '\v' || c == '\f');
+}
+
+
+operands::operands(const char *prog, int argc, char *const *argv, int optind)
+    : prog_(prog),
+      argc_(argc),
+      argv_(argv),
+      ind_(optind),
+      failures_(0),
+      file_(NULL),
+      active_(false),
+      nul_(false),
+      eof_(true),
+      in_(NULL),
+      pos_(NULL),
+      end_(NULL)
+{
+    map_.data = NULL;
+    map_.size = 0;
+    map_.handle = NULL;
+}
+
+
+operands::~operands()
+{
+    close();
+}
+
+
+const char *operands::next()
+{
+    for (;;)
+    {
+        if (active_)
+        {
+            const char *arg = token();
+            if (arg) return arg;
+            close();
+        }
+
+        if (ind_ >= argc_ || !argv_[ind_]) return NULL;
+
+        const char *arg = argv_[ind_++];
+        if (arg[0] != '@' || arg[1] == '\0') return arg;
+
+        if (!open(arg + 1))
+        {
+#if defined(_WIN32)
+            fprintf(stderr, "%s: cannot read '%s'.\n", prog_, arg + 1);
+#else
+            fprintf(stderr, "%s: cannot read '%s': %s.\n",
+                    prog_, arg + 1, strerror(errno));
+#endif
+            ++failures_;
+        }
+    }
+}
+
+
+bool operands::open(const char *file)
+{
+    file_ = file;
+
+    if (!strcmp(file, "-"))
+    {
+#if defined(_WIN32)
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+        in_ = stdin;
+        eof_ = false;
+        buffer_.resize(BlockSize + 1);  /* room for a final terminator */
+        pos_ = end_ = &buffer_[0];
+        char *start = pos_;
+        fill(start);
+        pos_ = start;
+    }
+    else
+    {
+        if (!map_file(file, map_, true)) return false;
+        eof_ = true;
+        pos_ = map_.data;
+        end_ = map_.data + map_.size;
+    }
+
+    size_t head = end_ - pos_;
+    if (head > BlockSize) head = BlockSize;
+    nul_ = (head && memchr(pos_, '\0', head) != NULL);
+    active_ = true;
+    return true;
+}
+
+
+void operands::close()
+{
+    if (map_.data || map_.handle) unmap_file(map_);
+    in_ = NULL;
+    active_ = false;
+    eof_ = true;
+    pos_ = end_ = NULL;
+}
+
+
+/**
+ * keep [start, end_) and read more of standard input after it.
+ * `start' is moved along with the data. returns false at the end.
+ */
+bool operands::fill(char *&start)
+{
+    if (eof_ || !in_) return false;
+
+    char *base = &buffer_[0];
+    size_t keep = end_ - start;
+    size_t capacity = buffer_.size() - 1;
+
+    if (start != base) memmove(base, start, keep);
+    if (keep == capacity)
+    {
+        /* a single argument fills the buffer. */
+        buffer_.resize(2 * capacity + 1);
+        base = &buffer_[0];
+        capacity = buffer_.size() - 1;
+    }
+
+    size_t n = fread(base + keep, 1, capacity - keep, in_);
+    start = base;
+    end_ = base + keep + n;
+
+    if (n == 0)
+    {
+        eof_ = true;
+        if (ferror(in_))
+        {
+            fprintf(stderr, "%s: error reading standard input.\n", prog_);
+            ++failures_;
+        }
+    }
+    return (n != 0);
+}
+
+
+/**
+ * find the end of the quoted argument starting at `p',
+ * or NULL if it runs to the end of the data read so far.
+ */
+char *operands::scan(char *p) const
+{
+    char quote = '\0';
+    for (; p < end_; ++p)
+    {
+        char c = *p;
+        if (quote == '\'')
+        {
+            if (c == '\'') quote = '\0';
+            continue;
+        }
+        if (c == '\\')
+        {
+            if (++p == end_) return NULL;
+            continue;
+        }
+        if (quote == '"')
+        {
+            if (c == '"') quote = '\0';
+            continue;
+        }
+        if (c == '"' || c == '\'')
+        {
+            quote = c;
+            continue;
+        }
+        if (isblank_(c)) return p;
+    }
+    return NULL;
+}
+
+
+/**
+ * remove the quotes and escapes of the argument [p, end) in place;
+ * returns the end of the result.
+ */
+char *operands::unquote(char *p, char *end) const
+{
+    char *w = p;
+    char quote = '\0';
+    for (; p < end; ++p)
+    {
+        char c = *p;
+        if (quote == '\'')
+        {
+            if (c == '\'') quote = '\0';
+            else *w++ = c;
+            continue;
+        }
+        if (c == '\\' && p + 1 < end)
+        {
+            *w++ = *++p;
+            continue;
+        }
+        if (quote == '"')
+        {
+            if (c == '"') quote = '\0';
+            else *w++ = c;
+            continue;
+        }
+        if (c == '"' || c == '\'')
+        {
+            quote = c;
+            continue;
+        }
+        *w++ = c;
+    }
+    return w;
+}
+
+
+/**
+ * get the next argument of the response file, or NULL at its end.
+ */
+const char *operands::token()
+{
+    for (;;)
+    {
+        if (nul_)
+        {
+            while (pos_ < end_ && *pos_ == '\0') ++pos_;
+        }
+        else
+        {
+            while (pos_ < end_ && isblank_(*pos_)) ++pos_;
+        }
+
+        if (pos_ == end_)
+        {
+            if (!fill(pos_)) return NULL;
+            continue;
+        }
+
+        char *start = pos_;
+        char *stop = nul_
+                   ? static_cast<char *>(memchr(start, '\0', end_ - start))
+                   : scan(start);
+        if (stop == NULL)
+        {
+            /* the argument may go on in the next block. */
+            if (fill(start))
+            {
+                pos_ = start;
+                continue;
+            }
+            stop = end_;
+        }
+
+        char *w = nul_ ? stop : unquote(start, stop);
+        pos_ = (stop < end_) ? stop + 1 : stop;
+
+        /* the buffer of standard input has a spare byte past end_. */
+        if (w < end_ || in_)
+        {
+            *w = '\0';
+            return start;
+        }
+
+        tail_.assign(start, w);
+        return tail_.c_str();
+    }
+}
+
+}   // namespace getopt
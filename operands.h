@@ -0,0 +1,115 @@
+#ifndef OPERANDS_H_INCLUDED
+#define OPERANDS_H_INCLUDED
+
+/**
+ * operands.h - the operands left after option parsing, read lazily.
+ * free to distribute under the GPL license.
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ *
+ * an operand "@file" stands for the arguments listed in file ("@-" for
+ * standard input), so an argument list is not limited by ARG_MAX.
+ * a list is NUL-delimited if its first block holds a NUL byte; otherwise
+ * arguments are separated by white space and may be quoted with "..." or
+ * '...', a backslash escaping the next character outside '...'.
+ * response files are not expanded recursively.
+ *
+ * files are mapped copy-on-write and unquoted in place; standard input is
+ * read in blocks. either way no argument vector is built: each operand
+ * stays valid only until the next one is requested.
+ *
+ *   getopt::operands args("touch", argc, argv, opt.optind());
+ *   for (const char *arg; (arg = args.next()); ) ...
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include "mapfile.h"
+
+
+namespace getopt
+{
+
+class operands
+{
+public:
+    /**
+     * `prog' prefixes the error messages; operands start at argv[optind].
+     */
+    operands(const char *prog, int argc, char *const *argv, int optind);
+    ~operands();
+
+    /**
+     * get the next operand, or NULL after the last one.
+     * a response file that cannot be read is reported and skipped.
+     */
+    const char *next();
+
+    /**
+     * the number of response files that could not be read.
+     */
+    int failures() const { return failures_; }
+
+    class iterator
+    {
+    public:
+        iterator(operands *source, const char *arg)
+            : source_(source),
+              arg_(arg)
+        {
+        }
+
+        const char *operator*() const { return arg_; }
+
+        iterator& operator++()
+        {
+            arg_ = source_->next();
+            return *this;
+        }
+
+        bool operator!=(const iterator& other) const { return arg_ != other.arg_; }
+
+    private:
+        operands *source_;
+        const char *arg_;
+    };
+
+    iterator begin() { return iterator(this, next()); }
+    iterator end() { return iterator(this, NULL); }
+
+private:
+    operands(const operands&);
+    operands& operator=(const operands&);
+
+    enum { BlockSize = 64 * 1024 };
+
+    bool open(const char *file);
+    void close();
+    bool fill(char *&start);
+    const char *token();
+    char *scan(char *p) const;
+    char *unquote(char *p, char *end) const;
+
+    const char *prog_;
+    int argc_;
+    char *const *argv_;
+    int ind_;
+    int failures_;
+
+    /* the response file being read */
+    const char *file_;
+    bool active_;
+    bool nul_;          /* NUL-delimited, not quoted */
+    bool eof_;          /* nothing beyond end_ */
+    mapfile_st map_;
+    FILE *in_;          /* standard input, if not mapped */
+    std::vector<char> buffer_;
+    char *pos_;
+    char *end_;
+    std::string tail_;  /* a last argument that cannot be terminated in place */
+};
+
+}   // namespace getopt
+
+#endif  /* OPERANDS_H_INCLUDED */
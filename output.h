@@ -0,0 +1,91 @@
+#ifndef OUTPUT_H_INCLUDED
+#define OUTPUT_H_INCLUDED
+
+/**
+ * output.h - buffered output for the utilities, in place of iostream,
+ * which costs every program its static initialization at startup.
+ * free to distribute under the GPL license.
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ *
+ * lines are gathered in a buffer of the writer's own and handed to stdio
+ * a buffer at a time; the destructor flushes what is left.
+ *
+ *   Output out(stdout);
+ *   out.line(path);
+ *   if (!out.flush()) ...
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <string_view>
+
+
+class Output
+{
+public:
+    explicit Output(FILE *file)
+        : file_(file),
+          len_(0)
+    {
+    }
+
+    ~Output()
+    {
+        flush();
+    }
+
+    void write(const char *s, size_t n)
+    {
+        if (n > BufSize - len_)
+        {
+            drain();
+            if (n >= BufSize)
+            {
+                fwrite(s, 1, n, file_);
+                return;
+            }
+        }
+        memcpy(buf_ + len_, s, n);
+        len_ += n;
+    }
+
+    void put(char c)
+    {
+        if (len_ == BufSize) drain();
+        buf_[len_++] = c;
+    }
+
+    void line(std::string_view s)
+    {
+        write(s.data(), s.size());
+        put('\n');
+    }
+
+    /**
+     * hand everything over to the file; returns false on a write error.
+     */
+    bool flush()
+    {
+        drain();
+        return (fflush(file_) == 0 && !ferror(file_));
+    }
+
+private:
+    Output(const Output&);
+    Output& operator=(const Output&);
+
+    enum { BufSize = 8192 };
+
+    void drain()
+    {
+        if (len_) fwrite(buf_, 1, len_, file_);
+        len_ = 0;
+    }
+
+    FILE *file_;
+    size_t len_;
+    char buf_[BufSize];
+};
+
+#endif  /* OUTPUT_H_INCLUDED */
@@ -0,0 +1,483 @@
+/**
+ * resolve.cpp - search the PATH environment variable for programs.
+ * a portable C++ implementation for Microsoft Windows and GNU/Linux.
+ *
+ * free to distribute under the GPL license.
+ * if you have not received a copy of the license along with the code,
+ * confer to http://www.gnu.org/licenses/gpl.html
+ *
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ */
+
+
+#include <sys/stat.h>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include "resolve.h"
+
+#if defined(_WIN32)
+#   include <windows.h>
+#else
+#   include <dirent.h>
+#   include <fcntl.h>
+#endif
+
+
+namespace which
+{
+
+#if defined(WHICH_STATS)
+Stats stats;
+#endif
+
+
+bool isProgram(const char *filename)
+{
+    WHICH_COUNT(stat);
+    struct stat buf;
+    return (!stat(filename, &buf) && !S_ISDIR(buf.st_mode));
+}
+
+
+Resolver::Resolver()
+{
+}
+
+
+/**
+ * split `storage' at PathSep into `fields', skipping empty entries.
+ * the views point into `storage', which must not change afterwards.
+ */
+void Resolver::split(std::string& storage,
+                     std::vector<std::string_view>& fields)
+{
+    fields.clear();
+
+    std::string_view rest(storage);
+    while (!rest.empty())
+    {
+        std::size_t n = rest.find(PathSep);
+        if (n == std::string_view::npos) n = rest.size();
+        if (n) fields.push_back(rest.substr(0, n));
+        rest.remove_prefix(n < rest.size() ? n + 1 : n);
+    }
+}
+
+
+void Resolver::init(std::string_view path, std::string_view pathext)
+{
+    path_.assign(path.data(), path.size());
+    pathext_.assign(pathext.data(), pathext.size());
+
+    for (std::string::iterator iter = pathext_.begin();
+         iter != pathext_.end();
+         ++iter)
+    {
+        *iter = static_cast<char>(tolower(static_cast<unsigned char>(*iter)));
+    }
+
+    split(path_, dirs_);
+    split(pathext_, exts_);
+}
+
+
+void Resolver::init()
+{
+    const char *path = getenv("PATH");
+    const char *pathext = getenv("PATHEXT");
+    init(path ? path : "", pathext ? pathext : "");
+}
+
+
+int
+Resolver::resolve(std::string_view name,
+                  int flags,
+                  Visitor visit,
+                  void *ctx) const
+{
+    char buffer[BufSize];
+    int matches = 0;
+
+    std::size_t nexts = (flags & PATHEXT) ? exts_.size() : 0;
+
+    for (std::vector<std::string_view>::const_iterator dir = dirs_.begin();
+         dir != dirs_.end();
+         ++dir)
+    {
+        /* "dir/name" is shared by every extension; build it once. */
+        std::size_t len = dir->size() + 1 + name.size();
+        if (len >= BufSize) continue;
+
+        memcpy(buffer, dir->data(), dir->size());
+        buffer[dir->size()] = Sep;
+        memcpy(buffer + dir->size() + 1, name.data(), name.size());
+
+        /* try the bare name first, then name + each extension. */
+        for (std::size_t i = 0; i <= nexts; ++i)
+        {
+            std::string_view ext = i ? exts_[i - 1] : std::string_view();
+            if (len + ext.size() >= BufSize) continue;
+
+            memcpy(buffer + len, ext.data(), ext.size());
+            buffer[len + ext.size()] = '\0';
+
+            if (!isProgram(buffer)) continue;
+
+            ++matches;
+            if (!visit(std::string_view(buffer, len + ext.size()), ctx) ||
+                !(flags & ALL))
+            {
+                return matches;
+            }
+        }
+    }
+
+    return matches;
+}
+
+
+struct CopyFirst
+{
+    char *out;
+    std::size_t size;
+    std::size_t len;
+};
+
+static bool copyFirst(std::string_view path, void *ctx)
+{
+    CopyFirst *first = static_cast<CopyFirst *>(ctx);
+    if (path.size() < first->size)
+    {
+        memcpy(first->out, path.data(), path.size());
+        first->out[path.size()] = '\0';
+        first->len = path.size();
+    }
+    return false;
+}
+
+
+std::size_t
+Resolver::resolve(std::string_view name,
+                  int flags,
+                  char *out,
+                  std::size_t size) const
+{
+    CopyFirst first = { out, size, 0 };
+    resolve(name, flags & ~ALL, copyFirst, &first);
+    return first.len;
+}
+
+
+/**
+ * match a bracket expression "[...]" starting at `p' against `c'.
+ * on return `p' is just past the closing ']'; false if it is unterminated.
+ */
+static bool bracketMatch(std::string_view pattern, std::size_t& p, char c,
+                         bool& matched)
+{
+    std::size_t i = p + 1;
+    bool negate = false;
+    if (i < pattern.size() && (pattern[i] == '!' || pattern[i] == '^'))
+    {
+        negate = true;
+        ++i;
+    }
+
+    matched = false;
+    for (bool first = true; i < pattern.size(); first = false)
+    {
+        char lo = pattern[i];
+        if (lo == ']' && !first)
+        {
+            p = i + 1;
+            matched = (matched != negate);
+            return true;
+        }
+
+        char hi = lo;
+        if (i + 2 < pattern.size() && pattern[i + 1] == '-' && pattern[i + 2] != ']')
+        {
+            hi = pattern[i + 2];
+            i += 3;
+        }
+        else
+        {
+            ++i;
+        }
+
+        if (lo <= c && c <= hi) matched = true;
+    }
+    return false;
+}
+
+
+bool globMatch(std::string_view pattern, std::string_view name)
+{
+    std::size_t p = 0, n = 0;
+    std::size_t starP = std::string_view::npos, starN = 0;
+
+    while (n < name.size())
+    {
+        if (p < pattern.size())
+        {
+            char c = pattern[p];
+            if (c == '*')
+            {
+                /* remember where to resume if the rest fails to match. */
+                starP = ++p;
+                starN = n;
+                continue;
+            }
+
+            if (c == '?')
+            {
+                ++p;
+                ++n;
+                continue;
+            }
+
+            if (c == '[')
+            {
+                std::size_t q = p;
+                bool matched;
+                if (bracketMatch(pattern, q, name[n], matched))
+                {
+                    if (matched)
+                    {
+                        p = q;
+                        ++n;
+                        continue;
+                    }
+                }
+                else if (name[n] == '[')
+                {
+                    /* an unterminated '[' stands for itself. */
+                    ++p;
+                    ++n;
+                    continue;
+                }
+            }
+            else
+            {
+                if (c == '\\' && p + 1 < pattern.size()) c = pattern[++p];
+                if (c == name[n])
+                {
+                    ++p;
+                    ++n;
+                    continue;
+                }
+            }
+        }
+
+        if (starP == std::string_view::npos) return false;
+        p = starP;
+        n = ++starN;
+    }
+
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return (p == pattern.size());
+}
+
+
+struct Index::Less
+{
+    const Index *index;
+
+    bool operator()(const Entry& a, const Entry& b) const
+    {
+        int cmp = index->name(a).compare(index->name(b));
+        return (cmp < 0 || (cmp == 0 && a.dir < b.dir));
+    }
+
+    bool operator()(const Entry& a, std::string_view key) const
+    {
+        return (index->name(a) < key);
+    }
+};
+
+
+Index::Index()
+{
+}
+
+
+/**
+ * append every entry of `dir' that is not a directory.
+ */
+void Index::scan(std::string_view dir, std::uint32_t rank)
+{
+#if defined(_WIN32)
+    std::string spec(dir);
+    spec += Sep;
+    spec += '*';
+
+    WHICH_COUNT(opendir);
+
+    WIN32_FIND_DATAA data;
+    HANDLE hFind = FindFirstFileA(spec.c_str(), &data);
+    if (hFind == INVALID_HANDLE_VALUE) return;
+
+    do
+    {
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+
+        Entry entry = { static_cast<std::uint32_t>(names_.size()),
+                        static_cast<std::uint32_t>(strlen(data.cFileName)),
+                        rank };
+        names_.append(data.cFileName, entry.len);
+        entries_.push_back(entry);
+    } while (WHICH_COUNT(readdir), FindNextFileA(hFind, &data));
+
+    FindClose(hFind);
+#else
+    std::string path(dir);
+    WHICH_COUNT(opendir);
+    DIR *d = opendir(path.c_str());
+    if (d == NULL) return;
+
+    for (;;)
+    {
+        WHICH_COUNT(readdir);
+        struct dirent *ent = readdir(d);
+        if (ent == NULL) break;
+
+        const char *file = ent->d_name;
+        if (file[0] == '.' && (!file[1] || (file[1] == '.' && !file[2])))
+        {
+            continue;
+        }
+
+#if defined(DT_DIR)
+        if (ent->d_type == DT_DIR) continue;
+        if (ent->d_type == DT_LNK || ent->d_type == DT_UNKNOWN)
+#endif
+        {
+            WHICH_COUNT(stat);
+            struct stat buf;
+            if (fstatat(dirfd(d), file, &buf, 0) || S_ISDIR(buf.st_mode))
+            {
+                continue;
+            }
+        }
+
+        Entry entry = { static_cast<std::uint32_t>(names_.size()),
+                        static_cast<std::uint32_t>(strlen(file)),
+                        rank };
+        names_.append(file, entry.len);
+        entries_.push_back(entry);
+    }
+
+    closedir(d);
+#endif
+}
+
+
+void Index::build(const Resolver& resolver)
+{
+    dirs_.assign(resolver.dirs().begin(), resolver.dirs().end());
+    names_.clear();
+    entries_.clear();
+
+    for (std::size_t i = 0; i < dirs_.size(); ++i)
+    {
+        scan(dirs_[i], static_cast<std::uint32_t>(i));
+    }
+
+    Less less = { this };
+    std::sort(entries_.begin(), entries_.end(), less);
+}
+
+
+/**
+ * report the entries in [first, last) whose names match `pattern'
+ * (every entry, if `pattern' is empty).
+ */
+int
+Index::report(const Entry *first,
+              const Entry *last,
+              std::string_view pattern,
+              int flags,
+              Resolver::Visitor visit,
+              void *ctx) const
+{
+    char buffer[Resolver::BufSize];
+    int matches = 0;
+
+    for (const Entry *entry = first; entry != last; ++entry)
+    {
+        std::string_view file = name(*entry);
+
+        /* entries sharing a name are adjacent, the winning one first. */
+        if (!(flags & ALL) && entry != first && name(entry[-1]) == file)
+        {
+            continue;
+        }
+
+        if (!pattern.empty() && !globMatch(pattern, file)) continue;
+
+        const std::string& dir = dirs_[entry->dir];
+        std::size_t len = dir.size() + 1 + file.size();
+        if (len >= Resolver::BufSize) continue;
+
+        memcpy(buffer, dir.data(), dir.size());
+        buffer[dir.size()] = Sep;
+        memcpy(buffer + dir.size() + 1, file.data(), file.size());
+        buffer[len] = '\0';
+
+        ++matches;
+        if (!visit(std::string_view(buffer, len), ctx)) break;
+    }
+
+    return matches;
+}
+
+
+int
+Index::prefix(std::string_view prefix,
+              int flags,
+              Resolver::Visitor visit,
+              void *ctx) const
+{
+    Less less = { this };
+    const Entry *begin = entries_.data();
+    const Entry *end = begin + entries_.size();
+
+    const Entry *first = std::lower_bound(begin, end, prefix, less);
+    const Entry *last = first;
+    while (last != end && name(*last).substr(0, prefix.size()) == prefix)
+    {
+        ++last;
+    }
+
+    return report(first, last, std::string_view(), flags, visit, ctx);
+}
+
+
+int
+Index::glob(std::string_view pattern,
+            int flags,
+            Resolver::Visitor visit,
+            void *ctx) const
+{
+    /* narrow the scan down to the literal head of the pattern. */
+    std::size_t n = pattern.find_first_of("*?[\\");
+    std::string_view head = pattern.substr(0, n);
+
+    Less less = { this };
+    const Entry *begin = entries_.data();
+    const Entry *end = begin + entries_.size();
+
+    const Entry *first = std::lower_bound(begin, end, head, less);
+    const Entry *last = first;
+    while (last != end && name(*last).substr(0, head.size()) == head)
+    {
+        ++last;
+    }
+
+    if (pattern.empty()) return 0;
+    return report(first, last, pattern, flags, visit, ctx);
+}
+
+}   // namespace which
@@ -0,0 +1,202 @@
+#ifndef RESOLVE_H_INCLUDED
+#define RESOLVE_H_INCLUDED
+
+/**
+ * resolve - search the PATH environment variable for programs.
+ * the reusable core of which(1), for callers that look up programs in-process.
+ *
+ * free to distribute under the GPL license.
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ *
+ * a Resolver copies PATH and PATHEXT once in init();
+ * after that, resolve() builds every candidate path in a buffer on the stack
+ * and performs no heap allocation.
+ *
+ * an Index lists every program in the search list once, sorted by name,
+ * to answer prefix and glob queries without touching the file system.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace which
+{
+
+#if defined(_WIN32)
+    const char Sep = '\\';
+    const char PathSep = ';';
+#else
+    const char Sep = '/';
+    const char PathSep = ':';
+#endif
+
+/**
+ * flags for Resolver::resolve
+ */
+enum
+{
+    ALL = 1 << 0,       /* report every match, not only the first one. */
+    PATHEXT = 1 << 1    /* also try name + each extension in PATHEXT. */
+};
+
+#if defined(_WIN32)
+    const int DefaultFlags = PATHEXT;
+#else
+    const int DefaultFlags = 0;
+#endif
+
+
+class Resolver
+{
+public:
+    /**
+     * called once per match with the full path of the candidate;
+     * `path' is only valid during the call. return false to stop the search.
+     */
+    typedef bool (*Visitor)(std::string_view path, void *ctx);
+
+    enum { BufSize = 4096 };
+
+    Resolver();
+
+    /**
+     * take the search list from `path' (directories separated by PathSep)
+     * and the extension list from `pathext' (also separated by PathSep).
+     * empty entries are skipped; extensions are folded to lower case.
+     */
+    void init(std::string_view path, std::string_view pathext);
+
+    /**
+     * same as above, from the PATH and PATHEXT environment variables.
+     */
+    void init();
+
+    /**
+     * look `name' up in each directory of the search list in turn,
+     * calling `visit' for every candidate that is a program (see isProgram).
+     * returns the number of matches reported.
+     */
+    int resolve(std::string_view name, int flags, Visitor visit, void *ctx) const;
+
+    /**
+     * copy the first match into `out' (NUL-terminated, at most `size' bytes).
+     * returns the length of the path, or 0 if there is no match.
+     */
+    std::size_t resolve(std::string_view name, int flags,
+                        char *out, std::size_t size) const;
+
+    const std::vector<std::string_view>& dirs() const { return dirs_; }
+    const std::vector<std::string_view>& exts() const { return exts_; }
+
+private:
+    Resolver(const Resolver&);
+    Resolver& operator=(const Resolver&);
+
+    static void split(std::string& storage,
+                      std::vector<std::string_view>& fields);
+
+    std::string path_;
+    std::string pathext_;
+    std::vector<std::string_view> dirs_;
+    std::vector<std::string_view> exts_;
+};
+
+
+/**
+ * sorted index of the programs in every directory of a search list.
+ * a program is any entry but a directory (symbolic links are followed),
+ * the rule of isProgram.
+ * like Resolver::resolve, a query reports a name only from the first
+ * directory that holds it, unless ALL is given; results come in name order,
+ * then in search order.
+ */
+class Index
+{
+public:
+    Index();
+
+    /**
+     * read every directory of `resolver' (replacing any previous content).
+     */
+    void build(const Resolver& resolver);
+
+    /**
+     * report the programs whose names begin with `prefix'.
+     */
+    int prefix(std::string_view prefix, int flags,
+               Resolver::Visitor visit, void *ctx) const;
+
+    /**
+     * report the programs whose names match `pattern'
+     * ('*', '?' and '[...]' as in fnmatch(3)).
+     */
+    int glob(std::string_view pattern, int flags,
+             Resolver::Visitor visit, void *ctx) const;
+
+    std::size_t size() const { return entries_.size(); }
+
+private:
+    struct Entry
+    {
+        std::uint32_t name;     /* offset into names_ */
+        std::uint32_t len;
+        std::uint32_t dir;      /* rank in the search list */
+    };
+
+    struct Less;
+
+    std::string_view name(const Entry& entry) const
+    {
+        return std::string_view(names_.data() + entry.name, entry.len);
+    }
+
+    void scan(std::string_view dir, std::uint32_t rank);
+
+    int report(const Entry *first, const Entry *last,
+               std::string_view pattern, int flags,
+               Resolver::Visitor visit, void *ctx) const;
+
+    std::vector<std::string> dirs_;
+    std::string names_;
+    std::vector<Entry> entries_;
+};
+
+
+/**
+ * match `name' against a shell wildcard `pattern'.
+ */
+bool globMatch(std::string_view pattern, std::string_view name);
+
+
+/**
+ * the match rule shared by Resolver and Index: a candidate is a program
+ * if stat(2) succeeds on it and it is not a directory.
+ * execute permission is not checked; a file that exists is reported.
+ */
+bool isProgram(const char *filename);
+
+
+#if defined(WHICH_STATS)
+/**
+ * file system calls made so far, for benchmarks (not thread-safe).
+ */
+struct Stats
+{
+    unsigned long stat;     /* stat(2) and fstatat(2) */
+    unsigned long opendir;
+    unsigned long readdir;
+};
+
+extern Stats stats;
+#   define WHICH_COUNT(field) (++which::stats.field)
+#else
+#   define WHICH_COUNT(field) ((void)0)
+#endif
+
+}   // namespace which
+
+#endif  /* RESOLVE_H_INCLUDED */
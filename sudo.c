@@ -1,5 +1,6 @@
 /**
  * sudo.c: Run a program as elevated.
+ * build with cmdline.cpp: cl sudo.c cmdline.cpp
  * Copyright (c) 2009 Ji Han.
  */
 
@@ -12,52 +13,7 @@
 
 #include <stdlib.h>
 
-#if !defined(NDEBUG)
-#   include <assert.h>
-#endif
-
-#if !defined(__cplusplus)
-    typedef enum {false, true} bool;
-#endif
-
-/* cmdlpbrk "command line pointer break"
- * returns a pointer to the first occurance in cmdl of any character in delims,
- * or a null pointer if there are no matches.
- * characters in a double quoted string are treated literally.
- * a double quotation mark begins/ends a quoted string,
- * unless it's following an odd number of backslashes and treated literally.
- * delims shall not contain the double quotation mark or the backslash.
- */
-const wchar_t*
-cmdlpbrk(const wchar_t* cmdl, const wchar_t* delims)
-{
-    const wchar_t* pwc = cmdl;
-    bool quote = false; /* next char is not quoted */
-    bool esc = false; /* next char is not escaped */
-
-#if !defined(NDEBUG)
-    /* '\"' and '\\' not allowed in delims */
-    assert(wcscspn(delims, L"\"\\") == wcslen(delims));
-#endif
-
-    for ( ; *pwc ; ++pwc)
-    {
-        switch(*pwc)
-          {
-            case L'\\':
-                esc = !esc;
-                break;
-            case L'"':
-                if (!esc) { quote = !quote; }
-                break;
-            default:
-                esc = false;
-                if (!quote && wcschr(delims, *pwc)) { return pwc; }
-          }
-    }
-
-    return NULL;
-}
+#include "cmdline.h"
 
 /* *** *** *** */
 LPCWSTR szTitle = L"sudo";
@@ -85,13 +41,13 @@ int APIENTRY wWinMain(HINSTANCE hInstance,
 
     szArgs = cmdlpbrk(lpCmdLine, szWhiteSpaces);
 
+    szExec = lpCmdLine;
     if (szArgs) {
+        /* lpCmdLine is ours to change: end the program name in place. */
         len = szArgs - lpCmdLine;
-        szExec = malloc(sizeof(wchar_t)*(len+1));
-        wcsncpy(szExec, lpCmdLine, len);
         szExec[len] = wcharNull;
+        szArgs = szExec + len + 1;
     } else {
-        szExec = lpCmdLine;
         szArgs = szNullString;
     }
 
@@ -0,0 +1,120 @@
+#ifndef THREADPOOL_H_INCLUDED
+#define THREADPOOL_H_INCLUDED
+
+/**
+ * threadpool.h - a fixed set of worker threads sharing one task queue.
+ * free to distribute under the GPL license.
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ *
+ * tasks may submit further tasks; wait() returns once the queue is empty
+ * and every worker is idle. producers that read ahead of the workers
+ * should call throttle() to bound the queue.
+ */
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+class ThreadPool
+{
+public:
+    typedef std::function<void()> Task;
+
+    /**
+     * start `threads' workers (the number of processors if 0).
+     */
+    explicit ThreadPool(unsigned threads = 0)
+        : busy_(0),
+          stop_(false)
+    {
+        if (threads == 0) threads = std::thread::hardware_concurrency();
+        if (threads == 0) threads = 1;
+
+        for (unsigned i = 0; i < threads; ++i)
+        {
+            threads_.push_back(std::thread(&ThreadPool::run, this));
+        }
+    }
+
+    ~ThreadPool()
+    {
+        wait();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        ready_.notify_all();
+        for (std::size_t i = 0; i < threads_.size(); ++i)
+        {
+            threads_[i].join();
+        }
+    }
+
+    std::size_t size() const { return threads_.size(); }
+
+    void submit(Task task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        ready_.notify_one();
+    }
+
+    /**
+     * block until fewer than `limit' tasks are queued.
+     * must not be called from a task.
+     */
+    void throttle(std::size_t limit)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        taken_.wait(lock, [&] { return tasks_.size() < limit; });
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        idle_.wait(lock, [&] { return tasks_.empty() && busy_ == 0; });
+    }
+
+private:
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;)
+        {
+            ready_.wait(lock, [&] { return stop_ || !tasks_.empty(); });
+            if (tasks_.empty()) return;     /* stopping */
+
+            Task task(std::move(tasks_.front()));
+            tasks_.pop_front();
+            ++busy_;
+            lock.unlock();
+            taken_.notify_all();
+
+            task();
+
+            lock.lock();
+            if (--busy_ == 0 && tasks_.empty()) idle_.notify_all();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable ready_;     /* a task was queued */
+    std::condition_variable taken_;     /* a task left the queue */
+    std::condition_variable idle_;      /* nothing queued or running */
+    std::deque<Task> tasks_;
+    unsigned busy_;
+    bool stop_;
+    std::vector<std::thread> threads_;
+};
+
+#endif  /* THREADPOOL_H_INCLUDED */
@@ -0,0 +1,784 @@
+/**
+ * timestamp.cpp - parse dates and times and turn them into epoch times.
+ * a portable C++ implementation for Microsoft Windows and GNU/Linux.
+ *
+ * free to distribute under the GPL license.
+ * if you have not received a copy of the license along with the code,
+ * confer to http://www.gnu.org/licenses/gpl.html
+ *
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ */
+
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "timestamp.h"
+
+
+static_assert(days_from_civil(1970, 1, 1) == 0, "epoch");
+static_assert(days_from_civil(2000, 3, 1) == 11017, "leap century");
+static_assert(days_from_civil(1601, 1, 1) == -134774, "FILETIME epoch");
+static_assert(civil_from_days(11016).m == 2 && civil_from_days(11016).d == 29, "2000-02-29");
+static_assert(civil_from_days(-1).y == 1969, "before the epoch");
+static_assert(weekday_from_days(0) == 4, "1970-01-01 was a Thursday");
+
+
+namespace
+{
+
+const int64_t SecondsPerDay = 86400;
+
+inline int64_t floorDiv(int64_t a, int64_t b)
+{
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+
+/**
+ * eight characters as a little-endian word.
+ */
+inline uint64_t load8(const char *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof v);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+/**
+ * true if the bytes of `v' selected by `mask' (0xFF each) are all digits.
+ */
+inline bool digits(uint64_t v, uint64_t mask)
+{
+    const uint64_t high = 0xF0F0F0F0F0F0F0F0ULL & mask;
+    const uint64_t zero = 0x3030303030303030ULL & mask;
+    v &= mask;
+    /* a digit is 0x3?, and stays so when 6 is added. */
+    return ((v & high) == zero &&
+            ((v + (0x0606060606060606ULL & mask)) & high) == zero);
+}
+
+/**
+ * turn a word of digits into two-digit numbers at bytes 0, 2, 4 and 6.
+ */
+inline uint64_t pairs(uint64_t v)
+{
+    v &= 0x0F0F0F0F0F0F0F0FULL;
+    return v * 10 + (v >> 8);
+}
+
+inline int byteAt(uint64_t v, unsigned i)
+{
+    return static_cast<int>((v >> (8 * i)) & 0xFF);
+}
+
+/**
+ * the two digits at bytes i and i + 1 of a word checked by digits().
+ */
+inline int pairAt(uint64_t v, unsigned i)
+{
+    return (byteAt(v, i) & 0x0F) * 10 + (byteAt(v, i + 1) & 0x0F);
+}
+
+
+bool valid(const datetime_st& dt)
+{
+    return (dt.MM >= 1 && dt.MM <= 12 &&
+            dt.DD >= 1 && dt.DD <= (int)last_day_of_month(dt.CCYY, dt.MM) &&
+            dt.hh >= 0 && dt.hh <= 23 &&
+            dt.mm >= 0 && dt.mm <= 59 &&
+            dt.SS >= 0 && dt.SS <= 60 &&     /* a leap second */
+            dt.nsec >= 0 && dt.nsec < 1000000000L);
+}
+
+
+/**
+ * the change to or from daylight saving time in a POSIX TZ rule.
+ */
+struct Change
+{
+    char kind;      /* 'J' (1-365, no leap day), 'D' (0-365) or 'M' */
+    int day;        /* of the year, or of the week with 'M' */
+    int week;       /* 1-5, 5 being the last */
+    int month;
+    int time;       /* seconds after midnight, local time */
+};
+
+/**
+ * a POSIX TZ rule, as in "CET-1CEST,M3.5.0,M10.5.0/3".
+ */
+struct Rule
+{
+    int stdoff;     /* seconds east of UTC */
+    bool dst;
+    int dstoff;
+    Change start;
+    Change end;
+};
+
+bool parseName(const char *&p)
+{
+    const char *begin = p;
+    if (*p == '<')
+    {
+        while (*p && *p != '>') ++p;
+        if (*p++ != '>') return false;
+        return (p - begin >= 5);
+    }
+    while ((*p >= 'A' && *p <= 'Z') || (*p >= 'a' && *p <= 'z')) ++p;
+    return (p - begin >= 3);
+}
+
+/**
+ * [+|-]hh[:mm[:ss]] in seconds.
+ */
+bool parseHms(const char *&p, int& seconds)
+{
+    int sign = 1;
+    if (*p == '+' || *p == '-') sign = (*p++ == '-') ? -1 : 1;
+    if (*p < '0' || *p > '9') return false;
+
+    int hh = 0;
+    while (*p >= '0' && *p <= '9' && hh < 1000) hh = hh * 10 + (*p++ - '0');
+    if (hh > 167) return false;
+
+    int mm = 0;
+    int ss = 0;
+    for (int *field = &mm; *p == ':' && field; field = (field == &mm) ? &ss : NULL)
+    {
+        ++p;
+        if (p[0] < '0' || p[0] > '9' || p[1] < '0' || p[1] > '9') return false;
+        *field = (p[0] - '0') * 10 + (p[1] - '0');
+        if (*field > 59) return false;
+        p += 2;
+    }
+
+    seconds = sign * (hh * 3600 + mm * 60 + ss);
+    return true;
+}
+
+bool parseNumber(const char *&p, int& n, int min, int max)
+{
+    if (*p < '0' || *p > '9') return false;
+    n = 0;
+    while (*p >= '0' && *p <= '9' && n <= max) n = n * 10 + (*p++ - '0');
+    return (n >= min && n <= max);
+}
+
+bool parseChange(const char *&p, Change& c)
+{
+    c.week = c.month = 0;
+    if (*p == 'J')
+    {
+        ++p;
+        c.kind = 'J';
+        if (!parseNumber(p, c.day, 1, 365)) return false;
+    }
+    else if (*p == 'M')
+    {
+        ++p;
+        c.kind = 'M';
+        if (!parseNumber(p, c.month, 1, 12) || *p++ != '.' ||
+            !parseNumber(p, c.week, 1, 5) || *p++ != '.' ||
+            !parseNumber(p, c.day, 0, 6))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        c.kind = 'D';
+        if (!parseNumber(p, c.day, 0, 365)) return false;
+    }
+
+    c.time = 2 * 3600;
+    if (*p == '/')
+    {
+        ++p;
+        return parseHms(p, c.time);
+    }
+    return true;
+}
+
+bool parseRule(const char *p, Rule& rule)
+{
+    int west;
+    if (!parseName(p) || !parseHms(p, west)) return false;
+    rule.stdoff = -west;
+    rule.dst = false;
+    if (*p == '\0') return true;
+
+    if (!parseName(p)) return false;
+    rule.dst = true;
+    rule.dstoff = rule.stdoff + 3600;
+    if (*p != ',' && *p != '\0')
+    {
+        if (!parseHms(p, west)) return false;
+        rule.dstoff = -west;
+    }
+
+    if (*p == '\0')
+    {
+        /* no changes given: the United States rules. */
+        p = ",M3.2.0,M11.1.0";
+    }
+    return (*p++ == ',' && parseChange(p, rule.start) &&
+            *p++ == ',' && parseChange(p, rule.end) && *p == '\0');
+}
+
+/**
+ * the local time of a change in year `y'.
+ */
+int64_t changeTime(const Change& c, int64_t y)
+{
+    int64_t day;
+    switch (c.kind)
+    {
+        case 'J':
+            day = days_from_civil(y, 1, 1) + c.day - 1 + (is_leap(y) && c.day >= 60);
+            break;
+
+        case 'D':
+            day = days_from_civil(y, 1, 1) + c.day;
+            break;
+
+        default:
+        {
+            int64_t first = days_from_civil(y, c.month, 1);
+            int64_t last = first + last_day_of_month(y, c.month) - 1;
+            day = first + (c.day + 7 - (int)weekday_from_days(first)) % 7 + 7 * (c.week - 1);
+            while (day > last) day -= 7;
+            break;
+        }
+    }
+    return day * SecondsPerDay + c.time;
+}
+
+int ruleOffset(const Rule& rule, int64_t t)
+{
+    if (!rule.dst) return rule.stdoff;
+
+    int64_t y = civil_from_days(floorDiv(t + rule.stdoff, SecondsPerDay)).y;
+    int64_t start = changeTime(rule.start, y) - rule.stdoff;
+    int64_t end = changeTime(rule.end, y) - rule.dstoff;
+
+    if (start < end) return (t >= start && t < end) ? rule.dstoff : rule.stdoff;
+    return (t >= end && t < start) ? rule.stdoff : rule.dstoff;
+}
+
+
+/**
+ * the local time zone: the transitions of a tzfile, then its rule.
+ */
+class Zone
+{
+public:
+    Zone()
+        : bucketBase_(0),
+          initial_(0),
+          hasRule_(false),
+          ruleBefore_(false),
+          loaded_(false)
+    {
+        load();
+        expandRule();
+        index();
+    }
+
+    bool loaded() const { return loaded_; }
+
+    int offset(int64_t t) const
+    {
+        if (!times_.empty() && t < times_.front())
+        {
+            return ruleBefore_ ? ruleOffset(rule_, t) : initial_;
+        }
+        if (times_.empty() || t >= times_.back())
+        {
+            if (hasRule_) return ruleOffset(rule_, t);
+            return times_.empty() ? initial_ : offsets_.back();
+        }
+        return offsets_[find(t)];
+    }
+
+    /**
+     * the UTC time of local time `local', taking the offsets in effect a day
+     * before and a day after: a time repeated by a change is taken at its
+     * first occurrence, a time skipped by one with the offset before it.
+     */
+    int64_t utc(int64_t local) const
+    {
+        int before = offset(local - SecondsPerDay);
+        int after = offset(local + SecondsPerDay);
+        if (before == after) return local - before;
+
+        int64_t early = local - before;
+        int64_t late = local - after;
+
+        bool earlyValid = (offset(early) == before);
+        bool lateValid = (offset(late) == after);
+        if (earlyValid && lateValid) return std::min(early, late);
+        if (lateValid) return late;
+        return early;
+    }
+
+private:
+    void load()
+    {
+        const char *tz = getenv("TZ");
+        if (tz && *tz == ':') ++tz;
+
+        if (tz && *tz == '\0')
+        {
+            loaded_ = true;     /* UTC */
+            return;
+        }
+
+        if (!tz)
+        {
+            loaded_ = loadFile("/etc/localtime");
+            return;
+        }
+
+        if (*tz == '/')
+        {
+            loaded_ = loadFile(tz);
+            return;
+        }
+
+        const char *dir = getenv("TZDIR");
+        std::string path(dir && *dir ? dir : "/usr/share/zoneinfo");
+        path += '/';
+        path += tz;
+        if (!strstr(tz, "..") && loadFile(path.c_str()))
+        {
+            loaded_ = true;
+            return;
+        }
+
+        hasRule_ = parseRule(tz, rule_);
+        loaded_ = hasRule_;
+    }
+
+    /**
+     * write the changes of a daylight saving rule out as transitions up to
+     * LastYear, so that offset() finds them with a binary search instead of
+     * working out the dates of the rule every time. a bare rule starts at
+     * FirstYear, and still applies before it.
+     */
+    void expandRule()
+    {
+        const int64_t FirstYear = 1900, LastYear = 2100;
+        if (!hasRule_ || !rule_.dst) return;
+
+        ruleBefore_ = times_.empty();
+        int64_t y = times_.empty()
+                  ? FirstYear
+                  : civil_from_days(floorDiv(times_.back(), SecondsPerDay)).y;
+
+        for (; y <= LastYear; ++y)
+        {
+            int64_t start = changeTime(rule_.start, y) - rule_.stdoff;
+            int64_t end = changeTime(rule_.end, y) - rule_.dstoff;
+            if (start < end)
+            {
+                addTransition(start, rule_.dstoff);
+                addTransition(end, rule_.stdoff);
+            }
+            else
+            {
+                addTransition(end, rule_.stdoff);
+                addTransition(start, rule_.dstoff);
+            }
+        }
+    }
+
+    /**
+     * the last transition at or before `t', from times_.front() to
+     * times_.back(). the transitions from 1900 on are reached through
+     * buckets of 2^Shift seconds (about 48 days), each holding the last
+     * transition before it starts, so that only a step or two is left.
+     */
+    size_t find(int64_t t) const
+    {
+        uint64_t b = (t < bucketBase_) ? UINT64_MAX
+                                       : (uint64_t)(t - bucketBase_) >> Shift;
+        if (b >= buckets_.size())
+        {
+            return std::upper_bound(times_.begin(), times_.end(), t) - times_.begin() - 1;
+        }
+
+        size_t i = buckets_[b];
+        while (times_[i + 1] <= t) ++i;
+        return i;
+    }
+
+    void index()
+    {
+        enum { MaxBuckets = 1 << 16 };
+        const int64_t Y1900 = -2208988800LL;
+
+        buckets_.clear();
+        if (times_.size() < 2) return;
+
+        bucketBase_ = std::max(times_.front(), Y1900);
+        uint64_t n = ((uint64_t)(times_.back() - bucketBase_) >> Shift) + 1;
+        if (n > MaxBuckets) n = MaxBuckets;
+
+        size_t i = 0;
+        for (uint64_t b = 0; b < n; ++b)
+        {
+            int64_t start = bucketBase_ + (int64_t)(b << Shift);
+            while (i + 1 < times_.size() && times_[i + 1] <= start) ++i;
+            buckets_.push_back((uint32_t)i);
+        }
+    }
+
+    void addTransition(int64_t t, int offset)
+    {
+        if (!times_.empty() && t <= times_.back()) return;
+        times_.push_back(t);
+        offsets_.push_back(offset);
+    }
+
+    bool loadFile(const char *path)
+    {
+        FILE *file = fopen(path, "rb");
+        if (!file) return false;
+
+        std::vector<unsigned char> data;
+        unsigned char block[4096];
+        for (size_t n; (n = fread(block, 1, sizeof block, file)) != 0; )
+        {
+            data.insert(data.end(), block, block + n);
+        }
+        fclose(file);
+        return parse(data);
+    }
+
+    static uint32_t be32(const unsigned char *p)
+    {
+        return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+    }
+
+    static int64_t be64(const unsigned char *p)
+    {
+        return (int64_t)((uint64_t)be32(p) << 32 | be32(p + 4));
+    }
+
+    /**
+     * read a tzfile (RFC 8536): the 64-bit data of version 2 and later,
+     * and its rule for the times after the last transition.
+     */
+    bool parse(const std::vector<unsigned char>& data)
+    {
+        enum { HeaderSize = 44 };
+        const unsigned char *p = data.empty() ? NULL : &data[0];
+        const unsigned char *end = p + data.size();
+        int timeSize = 4;
+
+        for (;;)
+        {
+            if (end - p < HeaderSize || memcmp(p, "TZif", 4) != 0) return false;
+
+            bool v2 = (p[4] >= '2');
+            uint32_t isutcnt = be32(p + 20);
+            uint32_t isstdcnt = be32(p + 24);
+            uint32_t leapcnt = be32(p + 28);
+            uint32_t timecnt = be32(p + 32);
+            uint32_t typecnt = be32(p + 36);
+            uint32_t charcnt = be32(p + 40);
+            p += HeaderSize;
+
+            uint64_t size = (uint64_t)timecnt * (timeSize + 1) + typecnt * 6 + charcnt +
+                            (uint64_t)leapcnt * (timeSize + 4) + isstdcnt + isutcnt;
+            if (typecnt == 0 || (uint64_t)(end - p) < size) return false;
+
+            if (v2 && timeSize == 4)
+            {
+                /* skip the 32-bit data for the 64-bit data after it. */
+                p += size;
+                timeSize = 8;
+                continue;
+            }
+
+            const unsigned char *idx = p + (size_t)timecnt * timeSize;
+            const unsigned char *types = idx + timecnt;
+
+            times_.resize(timecnt);
+            offsets_.resize(timecnt);
+            for (uint32_t i = 0; i < timecnt; ++i)
+            {
+                const unsigned char *t = p + (size_t)i * timeSize;
+                times_[i] = (timeSize == 8) ? be64(t) : (int32_t)be32(t);
+                if (idx[i] >= typecnt) return false;
+                offsets_[i] = (int32_t)be32(types + 6 * idx[i]);
+            }
+            initial_ = (int32_t)be32(types);
+            p += size;
+
+            /* the footer: "\nrule\n". */
+            if (timeSize == 8 && p < end && *p == '\n')
+            {
+                const unsigned char *eol = static_cast<const unsigned char *>(
+                    memchr(p + 1, '\n', end - p - 1));
+                if (eol && eol > p + 1)
+                {
+                    std::string tz(p + 1, eol);
+                    hasRule_ = parseRule(tz.c_str(), rule_);
+                }
+            }
+            return true;
+        }
+    }
+
+    enum { Shift = 22 };
+
+    std::vector<int64_t> times_;
+    std::vector<int32_t> offsets_;
+    std::vector<uint32_t> buckets_;
+    int64_t bucketBase_;
+    int32_t initial_;
+    bool hasRule_;
+    bool ruleBefore_;   /* a bare rule: it also applies before times_ */
+    Rule rule_;
+    bool loaded_;
+};
+
+/**
+ * read once, on first use, by whichever thread comes first.
+ */
+const Zone& localZone()
+{
+    static const Zone zone;
+    return zone;
+}
+
+
+/**
+ * local time by the C library, when there is no tzfile.
+ */
+bool libcUtc(const datetime_st& dt, int64_t& sec)
+{
+    struct tm tm;
+    memset(&tm, 0, sizeof tm);
+    tm.tm_sec = dt.SS;
+    tm.tm_min = dt.mm;
+    tm.tm_hour = dt.hh;
+    tm.tm_mday = dt.DD;
+    tm.tm_mon = dt.MM - 1;
+    tm.tm_year = dt.CCYY - 1900;
+    tm.tm_isdst = -1;   /* let the time zone decide */
+
+    errno = 0;
+    time_t t = mktime(&tm);
+    if (t == (time_t)-1 && errno) return false;
+    sec = t;
+    return true;
+}
+
+int libcOffset(int64_t sec)
+{
+    time_t t = (time_t)sec;
+    struct tm tm;
+#if defined(_WIN32)
+    if (localtime_s(&tm, &t)) return 0;
+#else
+    if (!localtime_r(&t, &tm)) return 0;
+#endif
+    int64_t local = days_from_civil(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday) * SecondsPerDay +
+                    tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec;
+    return (int)(local - sec);
+}
+
+
+int currentYear()
+{
+    int64_t now = (int64_t)time(NULL);
+    return (int)civil_from_days(floorDiv(now + timestamp_offset(now), SecondsPerDay)).y;
+}
+
+}   // namespace
+
+
+int timestamp_offset(int64_t sec)
+{
+    const Zone& zone = localZone();
+    return zone.loaded() ? zone.offset(sec) : libcOffset(sec);
+}
+
+
+bool timestamp_parse(const char *s, size_t len, datetime_st& dt)
+{
+    /* room for a whole word past either end of the digits. */
+    char buf[32] = { 0 };
+    if (len > 15) return false;
+    memcpy(buf + 8, s, len);
+    const char *p = buf + 8;
+
+    dt.SS = 0;
+    if (len >= 3 && p[len - 3] == '.')
+    {
+        uint64_t ss = load8(p + len - 2);
+        if (!digits(ss, 0xFFFF)) return false;
+        dt.SS = pairAt(ss, 0);
+        len -= 3;
+    }
+    if (len != 8 && len != 10 && len != 12) return false;
+
+    /* MMDDhhmm, and before it [CC]YY. */
+    uint64_t tail = load8(p + len - 8);
+    uint64_t head = load8(p + len - 12);
+    uint64_t headMask = ~0ULL << (8 * (12 - len));
+    if (!digits(tail, ~0ULL) || !digits(head, headMask)) return false;
+
+    tail = pairs(tail);
+    dt.MM = byteAt(tail, 0);
+    dt.DD = byteAt(tail, 2);
+    dt.hh = byteAt(tail, 4);
+    dt.mm = byteAt(tail, 6);
+
+    if (len == 12)
+    {
+        dt.CCYY = pairAt(head, 0) * 100 + pairAt(head, 2);
+    }
+    else if (len == 10)
+    {
+        int YY = pairAt(head, 2);
+        dt.CCYY = (YY >= 69 ? 1900 : 2000) + YY;
+    }
+    else
+    {
+        dt.CCYY = currentYear();
+    }
+
+    dt.nsec = 0;
+    dt.zoned = false;
+    dt.offset = 0;
+    return valid(dt);
+}
+
+
+bool timestamp_parse_iso(const char *s, size_t len, datetime_st& dt)
+{
+    /* "YYYY-MM-DDThh:mm:ss." is 20 characters, a fraction 9 more. */
+    char buf[64] = { 0 };
+    if (len > 40) return false;
+    memcpy(buf, s, len);
+    const char *p = buf;
+    const char *end = buf + len;
+
+    /* YYYY-MM-DD */
+    uint64_t date = load8(p);
+    uint64_t day = load8(p + 8);
+    if (len < 10 ||
+        !digits(date, 0x00FFFF00FFFFFFFFULL) || !digits(day, 0xFFFF) ||
+        byteAt(date, 4) != '-' || byteAt(date, 7) != '-')
+    {
+        return false;
+    }
+    dt.CCYY = pairAt(date, 0) * 100 + pairAt(date, 2);
+    dt.MM = pairAt(date, 5);
+    dt.DD = pairAt(day, 0);
+    dt.hh = dt.mm = dt.SS = 0;
+    dt.nsec = 0;
+    dt.zoned = false;
+    dt.offset = 0;
+    p += 10;
+
+    if (p < end)
+    {
+        /* Thh:mm[:ss] */
+        if (*p != 'T' && *p != 't' && *p != ' ') return false;
+        uint64_t time = load8(p + 1);
+        if (!digits(time, 0xFFFF00FFFFULL) || byteAt(time, 2) != ':') return false;
+        dt.hh = pairAt(time, 0);
+        dt.mm = pairAt(time, 3);
+        p += 6;
+
+        if (*p == ':')
+        {
+            if (!digits(time >> 48, 0xFFFF)) return false;
+            dt.SS = pairAt(time, 6);
+            p += 3;
+
+            if (*p == '.' || *p == ',')
+            {
+                int n = 0;
+                for (++p; *p >= '0' && *p <= '9'; ++p, ++n)
+                {
+                    if (n == 9) return false;
+                    dt.nsec = dt.nsec * 10 + (*p - '0');
+                }
+                if (n == 0) return false;
+                for (; n < 9; ++n) dt.nsec *= 10;
+            }
+        }
+
+        /* Z, or +hh[[:]mm] */
+        if (*p == 'Z' || *p == 'z')
+        {
+            dt.zoned = true;
+            ++p;
+        }
+        else if (*p == '+' || *p == '-')
+        {
+            int sign = (*p == '-') ? -1 : 1;
+            uint64_t zone = load8(p + 1);
+            if (!digits(zone, 0xFFFF)) return false;
+            int hh = pairAt(zone, 0);
+            int mm = 0;
+            p += 3;
+
+            /* minutes are optional, but a colon must have them. */
+            bool colon = (*p == ':');
+            if (colon) ++p;
+            if (colon || p < end)
+            {
+                zone = load8(p);
+                if (!digits(zone, 0xFFFF)) return false;
+                mm = pairAt(zone, 0);
+                p += 2;
+            }
+            if (hh > 23 || mm > 59) return false;
+            dt.zoned = true;
+            dt.offset = sign * (hh * 3600 + mm * 60);
+        }
+    }
+
+    return (p == end && valid(dt));
+}
+
+
+bool timestamp_convert(const datetime_st& dt, timestamp_st& ts)
+{
+    if (!valid(dt)) return false;
+
+    int64_t local = days_from_civil(dt.CCYY, dt.MM, dt.DD) * SecondsPerDay +
+                    dt.hh * 3600 + dt.mm * 60 + dt.SS;
+
+    const Zone& zone = localZone();
+    if (dt.zoned)
+    {
+        ts.sec = local - dt.offset;
+    }
+    else if (zone.loaded())
+    {
+        ts.sec = zone.utc(local);
+    }
+    else if (!libcUtc(dt, ts.sec))
+    {
+        return false;
+    }
+
+    ts.nsec = dt.nsec;
+    return true;
+}
@@ -0,0 +1,125 @@
+#ifndef TIMESTAMP_H_INCLUDED
+#define TIMESTAMP_H_INCLUDED
+
+/**
+ * timestamp.h - parse dates and times and turn them into epoch times.
+ * free to distribute under the GPL license.
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ *
+ * the fixed-width digit fields of a date are checked and decoded eight
+ * characters at a time in a 64-bit word. calendar dates become days with
+ * the constexpr arithmetic below, and local times become UTC through the
+ * time zone, read once from the tzfile named by $TZ or /etc/localtime
+ * (or taken from a POSIX TZ rule); mktime is used only when there is no
+ * tzfile, as on Microsoft Windows.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/**
+ * seconds and nanoseconds since 1970-01-01 00:00:00 UTC.
+ */
+typedef struct
+{
+    int64_t sec;
+    long nsec;
+} timestamp_st;
+
+typedef struct
+{
+    int SS;
+    int mm;
+    int hh;
+    int DD;
+    int MM;
+    int CCYY;
+    long nsec;      /* fraction of the second */
+    bool zoned;     /* given with a UTC offset, not in local time */
+    int offset;     /* seconds east of UTC, if zoned */
+} datetime_st;
+
+
+/**
+ * days since 1970-01-01 of a date in the proleptic Gregorian calendar.
+ */
+constexpr int64_t days_from_civil(int64_t y, unsigned m, unsigned d)
+{
+    y -= (m <= 2);
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+typedef struct
+{
+    int64_t y;
+    unsigned m;
+    unsigned d;
+} civil_st;
+
+/**
+ * the date `z' days after 1970-01-01.
+ */
+constexpr civil_st civil_from_days(int64_t z)
+{
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    const unsigned d = doy - (153 * mp + 2) / 5 + 1;
+    const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+    civil_st civil = { static_cast<int64_t>(yoe) + era * 400 + (m <= 2), m, d };
+    return civil;
+}
+
+/**
+ * the day of the week of `z' days after 1970-01-01, 0 being Sunday.
+ */
+constexpr unsigned weekday_from_days(int64_t z)
+{
+    return static_cast<unsigned>(z >= -4 ? (z + 4) % 7 : (z + 5) % 7 + 6);
+}
+
+constexpr bool is_leap(int64_t y)
+{
+    return (y % 4 == 0 && (y % 100 != 0 || y % 400 == 0));
+}
+
+constexpr unsigned last_day_of_month(int64_t y, unsigned m)
+{
+    return (m == 2) ? (is_leap(y) ? 29 : 28)
+                    : ((m == 4 || m == 6 || m == 9 || m == 11) ? 30 : 31);
+}
+
+
+/**
+ * parse the POSIX touch -t time "[[CC]YY]MMDDhhmm[.SS]" in [s, s + len),
+ * a local time; a year left out is the current one, and YY alone is
+ * 1969-2068.
+ */
+bool timestamp_parse(const char *s, size_t len, datetime_st& dt);
+
+/**
+ * parse an ISO-8601 date and time in [s, s + len):
+ * "YYYY-MM-DD[(T| )hh:mm[:ss[(.|,)fraction]][Z|(+|-)hh[[:]mm]]]",
+ * a local time unless a UTC offset is given.
+ */
+bool timestamp_parse_iso(const char *s, size_t len, datetime_st& dt);
+
+/**
+ * the epoch time of a date and time.
+ */
+bool timestamp_convert(const datetime_st& dt, timestamp_st& ts);
+
+/**
+ * the offset of local time from UTC at `sec', in seconds east.
+ */
+int timestamp_offset(int64_t sec);
+
+#endif  /* TIMESTAMP_H_INCLUDED */
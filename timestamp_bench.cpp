@@ -0,0 +1,222 @@
+/**
+ * timestamp_bench.cpp - throughput of timestamp.cpp.
+ * times timestamp_parse on touch -t times, timestamp_parse_iso on
+ * ISO-8601 dates, and timestamp_convert on local and zoned times, over a
+ * deterministic spread of dates in the zone of TZ (read once, up front).
+ *
+ * build: g++ -O2 -std=c++17 timestamp_bench.cpp timestamp.cpp
+ *
+ * SYNOPSIS: timestamp_bench [-n count] [-m min_rate]
+ *
+ * -m fails any run below `min_rate' operations per second.
+ *
+ * free to distribute under the GPL license.
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ */
+
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "timestamp.h"
+
+
+typedef std::chrono::steady_clock Clock;
+
+/* distinct inputs, cycled through; enough to defeat the branch predictor. */
+static const std::size_t Inputs = 4096;
+
+
+struct Result
+{
+    double seconds;
+    unsigned long count;
+    unsigned long failures;
+    int64_t checksum;
+};
+
+
+/**
+ * `n' dates from 1970 to 2037, with times, fractions and offsets.
+ */
+static std::vector<datetime_st> makeDates(std::size_t n)
+{
+    std::vector<datetime_st> dates;
+    unsigned long seed = 12345;
+    for (std::size_t k = 0; k < n; ++k)
+    {
+        seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+        unsigned long r = seed >> 16;
+
+        datetime_st dt;
+        dt.CCYY = 1970 + (int)(r % 68);
+        dt.MM = 1 + (int)(r / 68 % 12);
+        dt.DD = 1 + (int)(r / 816 % last_day_of_month(dt.CCYY, dt.MM));
+        dt.hh = (int)(r / 26112 % 24);
+        dt.mm = (int)(r / 626688 % 60);
+        dt.SS = (int)(r / 37601280 % 60);
+        dt.nsec = (long)(seed % 1000000000);
+        dt.zoned = (k % 4 == 3);
+        dt.offset = dt.zoned ? ((int)(r % 49) - 24) * 1800 : 0;
+        dates.push_back(dt);
+    }
+    return dates;
+}
+
+
+static std::string posixTime(const datetime_st& dt)
+{
+    char s[32];
+    snprintf(s, sizeof s, "%04d%02d%02d%02d%02d.%02d",
+             dt.CCYY, dt.MM, dt.DD, dt.hh, dt.mm, dt.SS);
+    return s;
+}
+
+
+static std::string isoTime(const datetime_st& dt)
+{
+    char s[64];
+    int len = snprintf(s, sizeof s, "%04d-%02d-%02dT%02d:%02d:%02d.%09ld",
+                       dt.CCYY, dt.MM, dt.DD, dt.hh, dt.mm, dt.SS, dt.nsec);
+    if (dt.zoned)
+    {
+        int offset = dt.offset < 0 ? -dt.offset : dt.offset;
+        snprintf(s + len, sizeof s - len, "%c%02d:%02d",
+                 dt.offset < 0 ? '-' : '+', offset / 3600, offset / 60 % 60);
+    }
+    return s;
+}
+
+
+template <class Parse>
+static Result runParse(Parse parse, const std::vector<std::string>& inputs,
+                       unsigned long count)
+{
+    Result r = { 0, count, 0, 0 };
+
+    Clock::time_point start = Clock::now();
+    for (unsigned long k = 0; k < count; ++k)
+    {
+        const std::string& s = inputs[k % inputs.size()];
+        datetime_st dt;
+        if (!parse(s.data(), s.size(), dt))
+        {
+            ++r.failures;
+            continue;
+        }
+        r.checksum += dt.DD + dt.SS;
+    }
+    r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return r;
+}
+
+
+static Result runConvert(const std::vector<datetime_st>& dates, bool zoned,
+                         unsigned long count)
+{
+    Result r = { 0, count, 0, 0 };
+
+    /* only the dates of one kind, so that the two paths are timed apart. */
+    std::vector<datetime_st> inputs;
+    for (std::size_t k = 0; k < dates.size(); ++k)
+    {
+        if (dates[k].zoned == zoned) inputs.push_back(dates[k]);
+    }
+
+    Clock::time_point start = Clock::now();
+    for (unsigned long k = 0; k < count; ++k)
+    {
+        timestamp_st ts;
+        if (!timestamp_convert(inputs[k % inputs.size()], ts))
+        {
+            ++r.failures;
+            continue;
+        }
+        r.checksum += ts.sec;
+    }
+    r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    return r;
+}
+
+
+static bool report(const char *label, const Result& r, double minRate)
+{
+    double rate = r.count / r.seconds;
+    printf("%-22s %8.1f M/s  %8.2f ns each  (checksum %lld)\n",
+           label, rate / 1e6, r.seconds * 1e9 / r.count,
+           (long long)r.checksum);
+
+    bool ok = true;
+    if (r.failures)
+    {
+        fprintf(stderr, "timestamp_bench: %s: %lu inputs failed.\n",
+                label, r.failures);
+        ok = false;
+    }
+    if (minRate && rate < minRate)
+    {
+        fprintf(stderr, "timestamp_bench: %s: below %.0f per second.\n",
+                label, minRate);
+        ok = false;
+    }
+    return ok;
+}
+
+
+static bool parseCount(const char *s, unsigned long& value)
+{
+    char *end = NULL;
+    value = strtoul(s, &end, 10);
+    return (*s && !*end);
+}
+
+
+int main(int argc, char **argv)
+{
+    unsigned long count = 20000000, minRate = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        unsigned long value;
+        if (argv[i][0] != '-' || !argv[i][1] || argv[i][2] ||
+            i + 1 >= argc || !parseCount(argv[i + 1], value))
+        {
+            fprintf(stderr, "usage: timestamp_bench [-n count] [-m min_rate]\n");
+            return EXIT_FAILURE;
+        }
+
+        switch (argv[i++][1])
+        {
+            case 'n': count = value; break;
+            case 'm': minRate = value; break;
+            default:  fprintf(stderr,
+                              "usage: timestamp_bench [-n count] [-m min_rate]\n");
+                      return EXIT_FAILURE;
+        }
+    }
+    if (!count) count = 1;
+
+    std::vector<datetime_st> dates = makeDates(Inputs);
+    std::vector<std::string> posix, iso;
+    for (std::size_t k = 0; k < dates.size(); ++k)
+    {
+        posix.push_back(posixTime(dates[k]));
+        iso.push_back(isoTime(dates[k]));
+    }
+
+    /* read the time zone before the clock starts. */
+    timestamp_offset(0);
+
+    const char *tz = getenv("TZ");
+    printf("%lu operations each, TZ=%s\n", count, tz ? tz : "(unset)");
+
+    bool ok = true;
+    ok &= report("parse -t", runParse(timestamp_parse, posix, count), minRate);
+    ok &= report("parse ISO-8601", runParse(timestamp_parse_iso, iso, count), minRate);
+    ok &= report("convert local", runConvert(dates, false, count), minRate);
+    ok &= report("convert zoned", runConvert(dates, true, count), minRate);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
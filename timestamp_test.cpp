@@ -0,0 +1,231 @@
+/**
+ * timestamp_test.cpp - compare timestamp.cpp with the C library.
+ * for each time zone, in a process of its own (the zone is read once),
+ * converts local times with timestamp_convert and with mktime, and
+ * offsets with timestamp_offset and localtime_r, hour by hour from
+ * 1970 to 2037; any difference is a failure. fixed cases check the
+ * zone offsets timestamp_parse_iso takes and rejects.
+ * for GNU/Linux and other POSIX systems with a tz database.
+ *
+ * build: g++ -O2 -std=c++17 timestamp_test.cpp timestamp.cpp
+ *
+ * SYNOPSIS: timestamp_test [zone...]
+ *
+ * a zone is anything TZ takes: a tzfile name or a POSIX rule.
+ * glibc's mktime ignores the DST of a bare rule before 1970, which is
+ * why the comparison starts there.
+ *
+ * free to distribute under the GPL license.
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ */
+
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include "timestamp.h"
+
+
+static const char *const DefaultZones[] =
+{
+    "Europe/Berlin",
+    "America/New_York",
+    "Australia/Sydney",
+    "America/Sao_Paulo",
+    "Europe/London",
+    "Asia/Kolkata",
+    "UTC",
+    "CET-1CEST,M3.5.0,M10.5.0/3"
+};
+
+
+/**
+ * an ISO-8601 date and time, with the offset it has, or without one
+ * (NoZone), or rejected (Invalid).
+ */
+struct IsoCase
+{
+    const char *text;
+    int offset;
+};
+
+enum { NoZone = 1, Invalid = 2 };
+
+static const IsoCase IsoCases[] =
+{
+    { "2020-01-02T03:04", NoZone },
+    { "2020-01-02T03:04:05.5", NoZone },
+    { "2020-01-02T03:04Z", 0 },
+    { "2020-01-02T03:04:05z", 0 },
+    { "2020-01-02T03:04+05", 5 * 3600 },
+    { "2020-01-02T03:04+0530", 5 * 3600 + 30 * 60 },
+    { "2020-01-02T03:04+05:30", 5 * 3600 + 30 * 60 },
+    { "2020-01-02T03:04:05-09:30", -(9 * 3600 + 30 * 60) },
+    { "2020-01-02T03:04+05:", Invalid },
+    { "2020-01-02T03:04+05:3", Invalid },
+    { "2020-01-02T03:04+053", Invalid },
+    { "2020-01-02T03:04+05:30:", Invalid },
+    { "2020-01-02T03:04+5", Invalid },
+    { "2020-01-02T03:04+", Invalid },
+    { "2020-01-02T03:04+24", Invalid },
+    { "2020-01-02T03:04+05:60", Invalid },
+    { "2020-01-02T03:04Z+01", Invalid }
+};
+
+
+/**
+ * check timestamp_parse_iso on IsoCases. returns the number of failures.
+ */
+static int checkIso()
+{
+    int bad = 0;
+    for (std::size_t i = 0; i < sizeof IsoCases / sizeof IsoCases[0]; ++i)
+    {
+        const IsoCase& c = IsoCases[i];
+        datetime_st dt;
+        bool ok = timestamp_parse_iso(c.text, strlen(c.text), dt);
+
+        bool right = (c.offset == Invalid) ? !ok
+                   : (c.offset == NoZone) ? (ok && !dt.zoned)
+                   : (ok && dt.zoned && dt.offset == c.offset);
+        if (!right)
+        {
+            ++bad;
+            fprintf(stderr, "timestamp_test: '%s': %s, offset %d.\n",
+                    c.text, ok ? "accepted" : "rejected", ok ? dt.offset : 0);
+        }
+    }
+    printf("%-30s %8lu ISO-8601 times, %d failures\n", "timestamp_parse_iso",
+           (unsigned long)(sizeof IsoCases / sizeof IsoCases[0]), bad);
+    return bad;
+}
+
+
+/**
+ * compare every hour (at a minute that moves through the hour) of
+ * 1970-2037 in the zone of TZ. returns the number of differences.
+ */
+static unsigned long compareZone(const char *zone, unsigned long& samples)
+{
+    unsigned long bad = 0;
+    samples = 0;
+
+    for (int year = 1970; year <= 2037; ++year)
+    {
+        for (unsigned month = 1; month <= 12; ++month)
+        {
+            unsigned days = last_day_of_month(year, month);
+            for (unsigned day = 1; day <= days; ++day)
+            {
+                for (int hour = 0; hour < 24; ++hour)
+                {
+                    int minute = (int)(day * 7 + hour) % 60;
+                    datetime_st dt = { (hour * 13) % 60, minute, hour,
+                                       (int)day, (int)month, year,
+                                       0, false, 0 };
+
+                    struct tm tm;
+                    memset(&tm, 0, sizeof tm);
+                    tm.tm_sec = dt.SS;
+                    tm.tm_min = dt.mm;
+                    tm.tm_hour = dt.hh;
+                    tm.tm_mday = dt.DD;
+                    tm.tm_mon = dt.MM - 1;
+                    tm.tm_year = dt.CCYY - 1900;
+                    tm.tm_isdst = -1;
+                    int64_t want = (int64_t)mktime(&tm);
+
+                    timestamp_st ts;
+                    bool ok = timestamp_convert(dt, ts);
+
+                    time_t t = (time_t)want;
+                    struct tm local;
+                    localtime_r(&t, &local);
+                    int offset = timestamp_offset(want);
+
+                    ++samples;
+                    if (!ok || ts.sec != want || offset != local.tm_gmtoff)
+                    {
+                        if (bad++ < 5)
+                        {
+                            fprintf(stderr,
+                                    "timestamp_test: %s: %04d-%02d-%02d "
+                                    "%02d:%02d:%02d is %lld, mktime says "
+                                    "%lld; offset %d, localtime says %ld.\n",
+                                    zone, dt.CCYY, dt.MM, dt.DD,
+                                    dt.hh, dt.mm, dt.SS,
+                                    ok ? (long long)ts.sec : -1LL,
+                                    (long long)want,
+                                    offset, (long)local.tm_gmtoff);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return bad;
+}
+
+
+/**
+ * run compareZone in a child with TZ set to `zone'.
+ */
+static bool testZone(const char *zone)
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        perror("timestamp_test: fork");
+        return false;
+    }
+
+    if (pid == 0)
+    {
+        setenv("TZ", zone, 1);
+        tzset();
+
+        unsigned long samples;
+        unsigned long bad = compareZone(zone, samples);
+        printf("%-30s %8lu local times, %lu differences\n",
+               zone, samples, bad);
+        fflush(stdout);
+        _exit(bad ? EXIT_FAILURE : EXIT_SUCCESS);
+    }
+
+    int status;
+    if (waitpid(pid, &status, 0) < 0) return false;
+    return (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS);
+}
+
+
+int main(int argc, char **argv)
+{
+    int failures = checkIso() ? 1 : 0;
+
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            if (!testZone(argv[i])) ++failures;
+        }
+    }
+    else
+    {
+        for (std::size_t i = 0; i < sizeof DefaultZones / sizeof DefaultZones[0]; ++i)
+        {
+            if (!testZone(DefaultZones[i])) ++failures;
+        }
+    }
+
+    if (failures)
+    {
+        fprintf(stderr, "timestamp_test: %d checks failed.\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("timestamp_test: all passed.\n");
+    return EXIT_SUCCESS;
+}
@@ -1,6 +1,6 @@
 /**
  * touch - change file access and modification times
- * C++ implementation for Microsoft Windows.
+ * a portable C++ implementation for Microsoft Windows and GNU/Linux.
  *
  * free to distribute under the GPL license.
  * if you have not received a copy of the license along with the code,
@@ -10,183 +10,210 @@
  */
 
 
-#include <windows.h>
-#include <atltime.h>
-#include "getopt.h"
+#include <stdlib.h>
+#include <string.h>
+#include "getopt.hpp"
+#include "operands.h"
+#include "touch.h"
+#include "utils.h"
 
+#if defined(_WIN32)
+#   include <fcntl.h>
+#   include <io.h>
+#endif
 
-typedef struct
-{
-    bool a;
-    bool c;
-    bool m;
-} flags_st;
 
 typedef struct
 {
     const char *ref_file;
     const char *time;
+    const char *date;   /* ISO-8601 */
+    const char *from0;  /* NUL-delimited list of files */
+    bool stdin0;        /* the same list on standard input */
+    const char *manifest;   /* per-file times to apply */
+    bool dump;          /* write a manifest instead of touching */
 } optargs_st;
 
-typedef struct
-{
-    int SS;
-    int mm;
-    int hh;
-    int DD;
-    int MM;
-    int CCYY;
-} datetime_st;
-
 
-void usage()
+static void usage()
 {
     fprintf(stdout,
             "\n"
             "touch - change file access and modification times\n"
             "(C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).\n"
             "\n"
-            "SYNOPSIS: touch [-acm] [-r ref_file | -t time] file...\n"
+            "SYNOPSIS: touch [-acmR] [-r ref_file | -t time | -d date]\n"
+            "                [--from0 list | --stdin0] [--manifest file] file...\n"
+            "       touch --dump-manifest dir...\n"
+            "\n"
+            "an operand @list stands for the names in list (@- for stdin),\n"
+            "NUL-delimited or separated by white space and quoted.\n"
+            "\n"
+            "  -d date          use the ISO-8601 date and time\n"
+            "                   YYYY-MM-DD[Thh:mm[:ss[.frac]][Z|+hh:mm]].\n"
+            "  -R               also touch everything below each directory,\n"
+            "                   listed ones included.\n"
+            "  --from0 list     also touch the NUL-delimited names in list.\n"
+            "  --stdin0         also touch the NUL-delimited names on stdin.\n"
+            "  --manifest file  also set each file named in the manifest\n"
+            "                   (path<TAB>atime<TAB>mtime lines, each time in\n"
+            "                   seconds since the epoch or in ISO-8601).\n"
+            "  --dump-manifest  write the manifest of each directory tree.\n"
             "\n"
             "for further information, see\n"
             "http://www.opengroup.org/onlinepubs/009695399/utilities/touch.html\n");
+    fflush(stdout);
 }
 
 
 /**
- * parse options in command-line arguments
+ * parse options in command-line arguments; false after reporting an error.
  */
-void optparse(int argc, char **argv, flags_st& flags, optargs_st& optargs, int& ind)
+enum
+{
+    OPT_FROM0 = 256,
+    OPT_STDIN0,
+    OPT_MANIFEST,
+    OPT_DUMP_MANIFEST
+};
+
+static constexpr getopt::longopt longopts[] =
 {
-    opt_st *opt = NULL;
-    opt_init(&opt, malloc);
+    { "from0", getopt::required_argument, OPT_FROM0 },
+    { "stdin0", getopt::no_argument, OPT_STDIN0 },
+    { "manifest", getopt::required_argument, OPT_MANIFEST },
+    { "dump-manifest", getopt::no_argument, OPT_DUMP_MANIFEST }
+};
 
-    for (int c; (c = getopt_r(argc, argv, ":acmr:t:", opt)) != -1; )
+static constexpr auto optspec = getopt::make_spec(":acmRr:t:d:", longopts);
+
+static bool optparse(int argc, char **argv, flags_st& flags, optargs_st& optargs, int& ind)
+{
+    getopt::parser opt(optspec);
+
+    for (int c; (c = opt(argc, argv)) != -1; )
     {
         switch (c)
         {
             case 'a': flags.a = true;
                       break;
 
+            case 'R': flags.R = true;
+                      break;
+
             case 'c': flags.c = true;
                       break;
 
             case 'm': flags.m = true;
                       break;
 
-            case 'r': optargs.ref_file = optarg(opt);
+            case 'r': optargs.ref_file = opt.optarg();
                       optargs.time = NULL;
+                      optargs.date = NULL;
                       break;
 
-            case 't': optargs.time = optarg(opt);
+            case 't': optargs.time = opt.optarg();
                       optargs.ref_file = NULL;
+                      optargs.date = NULL;
                       break;
 
-            case ':': fprintf(stderr,
-                              "touch: option '-%c' requires an operand.\n",
-                              optopt(opt));
-                      usage();
-                      free(opt);
-                      exit(EXIT_FAILURE);
+            case 'd': optargs.date = opt.optarg();
+                      optargs.ref_file = NULL;
+                      optargs.time = NULL;
+                      break;
 
-            case '?': fprintf(stderr,
-                              "touch: invalid option: '-%c'.\n",
-                              optopt(opt));
+            case OPT_FROM0:
+                      optargs.from0 = opt.optarg();
+                      break;
+
+            case OPT_STDIN0:
+                      optargs.stdin0 = true;
+                      break;
+
+            case OPT_MANIFEST:
+                      optargs.manifest = opt.optarg();
+                      break;
+
+            case OPT_DUMP_MANIFEST:
+                      optargs.dump = true;
+                      break;
+
+            case ':': if (opt.longopt())
+                      {
+                          fprintf(stderr,
+                                  "touch: option '%s' requires an operand.\n",
+                                  opt.longopt());
+                      }
+                      else
+                      {
+                          fprintf(stderr,
+                                  "touch: option '-%c' requires an operand.\n",
+                                  opt.optopt());
+                      }
                       usage();
-                      free(opt);
-                      exit(EXIT_FAILURE);
+                      return false;
+
+            case '?': if (opt.longopt())
+                      {
+                          fprintf(stderr,
+                                  "touch: invalid option: '%s'.\n",
+                                  opt.longopt());
+                      }
+                      else
+                      {
+                          fprintf(stderr,
+                                  "touch: invalid option: '-%c'.\n",
+                                  opt.optopt());
+                      }
+                      usage();
+                      return false;
         }
     }
-    ind = optind(opt);
-    free(opt);
+    ind = opt.optind();
+    return true;
 }
 
 
-/**
- * parse string "[[CC]YY]MMDDhhmm[.SS]" as date and time
- */
-bool timeparse(char *time, datetime_st& datetime)
+void touch_error(const char *path)
 {
-    /* get SS */
-    int SS = 0;
-
-    char *end = strchr(time, '\0');
-    char *dot = strchr(time, '.');
-    if (dot)
-    {
-        SS = strtol(dot + 1, NULL, 10);
-        *(end = dot) = '\0';
-    }
-
-    ptrdiff_t len = end - time;
-    if (SS < 0 || SS > 60 ||
-        !(len == 8 || len == 10 || len == 12))
-    {
-        return false;
-    }
-
-    /* get mm, hh, DD, MM */
-    int mm, hh, DD, MM;
-
-    mm = strtol(end - 2, NULL, 10);
-    *(end -= 2) = '\0';
-    hh = strtol(end - 2, NULL, 10);
-    *(end -= 2) = '\0';
-    DD = strtol(end - 2, NULL, 10);
-    *(end -= 2) = '\0';
-    MM = strtol(end - 2, NULL, 10);
-    *(end -= 2) = '\0';
-
-    if (mm < 0 || mm > 59 ||
-        hh < 0 || hh > 23 ||
-        DD < 1 || DD > 31 ||
-        MM < 1 || MM > 12)
-    {
-        return false;
-    }
+    fprintf(stderr, "touch: cannot touch '%s': %s.\n", path, touch_strerror());
+}
 
-    /* get CCYY */
-    int CCYY;
 
-    if (len == 12)
-    {
-        CCYY = strtol(end - 4, NULL, 10);
-        if (CCYY < 1601) return false;
-    }
-    else if (len == 10)
-    {
-        int YY = strtol(end - 2, NULL, 10);
-        int CC = (YY >= 69) ? 19 : 20;
-        CCYY = 100 * CC + YY;
-    }
-    else /* len == 8 */
-    {
-        SYSTEMTIME st;
-        GetSystemTime(&st);
-        CCYY = st.wYear;
-    }
-
-    datetime.SS = SS;
-    datetime.mm = mm;
-    datetime.hh = hh;
-    datetime.DD = DD;
-    datetime.MM = MM;
-    datetime.CCYY = CCYY;
-    return true;
+static const char *nextOperand(void *ctx)
+{
+    return static_cast<getopt::operands *>(ctx)->next();
 }
 
 
-int main (int argc, char** argv)
+int touch_main(int argc, char **argv)
 {
-    HANDLE hFile;
-    FILETIME atime;
-    FILETIME mtime;
-    SYSTEMTIME st;
+    timestamp_st atime;
+    timestamp_st mtime;
 
-    flags_st flags = { false, false, false };
-    optargs_st optargs = { NULL, NULL };
+    flags_st flags = { false, false, false, false };
+    optargs_st optargs = { NULL, NULL, NULL, NULL, false, NULL, false };
     int ind;
-    optparse(argc, argv, flags, optargs, ind);
+    if (!optparse(argc, argv, flags, optargs, ind)) return EXIT_FAILURE;
+
+    getopt::operands args("touch", argc, argv, ind);
+
+    if (optargs.dump)
+    {
+        int failures = 0;
+        if (ind == argc) failures += touch_dump(".", stdout, 0);
+        for (const char *arg; (arg = args.next()); )
+        {
+            failures += touch_dump(arg, stdout, 0);
+        }
+        failures += args.failures();
+        if (fflush(stdout))
+        {
+            fprintf(stderr, "touch: error writing the manifest.\n");
+            ++failures;
+        }
+        return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
 
     /**
      * if neither the -a nor -m options were specified,
@@ -203,72 +230,92 @@ int main (int argc, char** argv)
      */
     if (optargs.ref_file)
     {
-        hFile = CreateFile(optargs.ref_file,
-                           GENERIC_READ,
-                           FILE_SHARE_READ,
-                           NULL,
-                           OPEN_EXISTING,
-                           FILE_FLAG_BACKUP_SEMANTICS,
-                           NULL);
-        if (!GetFileTime(hFile, NULL, &atime, &mtime))
+        if (!touch_stat(optargs.ref_file, atime, mtime))
         {
             fprintf(stderr,
                     "touch: error opening '%s': no such file or directory.\n",
                     optargs.ref_file);
             usage();
-            exit(EXIT_FAILURE);
+            return EXIT_FAILURE;
         }
-        CloseHandle(hFile);
     }
-    else if (optargs.time)
+    else if (optargs.time || optargs.date)
     {
-        char time[16];
-        strncpy(time, optargs.time, 16);
+        const char *time = optargs.time ? optargs.time : optargs.date;
         datetime_st datetime;
-        if (!timeparse(time, datetime))
+        bool parsed = optargs.time
+                    ? timestamp_parse(time, strlen(time), datetime)
+                    : timestamp_parse_iso(time, strlen(time), datetime);
+        if (!parsed || !timestamp_convert(datetime, atime))
         {
             fprintf(stderr,
                     "touch: error parsing '%s': invalid date format.\n",
-                    optargs.time);
+                    time);
             usage();
-            exit(EXIT_FAILURE);
+            return EXIT_FAILURE;
         }
-        CTime ctime(datetime.CCYY,
-                    datetime.MM,
-                    datetime.DD,
-                    datetime.hh,
-                    datetime.mm,
-                    datetime.SS);
-        ctime.GetAsSystemTime(st);
-        if (flags.a) SystemTimeToFileTime(&st, &atime);
-        if (flags.m) SystemTimeToFileTime(&st, &mtime);
+        mtime = atime;
     }
     else
     {
-        GetSystemTime(&st);
-        if (flags.a) SystemTimeToFileTime(&st, &atime);
-        if (flags.m) SystemTimeToFileTime(&st, &mtime);
+        touch_now(atime);
+        mtime = atime;
     }
 
     /**
      * set file timestamps
      */
-    for (int i = ind; i < argc; ++i)
+    const timestamp_st *pa = flags.a ? &atime : NULL;
+    const timestamp_st *pm = flags.m ? &mtime : NULL;
+    int failures = 0;
+
+    if (optargs.from0)
+    {
+        FILE *list = fopen(optargs.from0, "rb");
+        if (!list)
+        {
+            fprintf(stderr,
+                    "touch: error opening '%s': no such file or directory.\n",
+                    optargs.from0);
+            return EXIT_FAILURE;
+        }
+        failures += touch_list(list, flags, pa, pm, 0);
+        fclose(list);
+    }
+
+    if (optargs.manifest)
+    {
+        failures += touch_manifest(optargs.manifest, flags, 0);
+    }
+
+    if (optargs.stdin0)
+    {
+#if defined(_WIN32)
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+        failures += touch_list(stdin, flags, pa, pm, 0);
+    }
+
+    if (flags.R)
+    {
+        for (const char *arg; (arg = args.next()); )
+        {
+            failures += touch_tree(arg, flags, pa, pm, 0);
+        }
+    }
+    else
     {
-        hFile = CreateFile(argv[i],
-                           GENERIC_READ | GENERIC_WRITE,
-                           FILE_SHARE_READ | FILE_SHARE_WRITE,
-                           NULL,
-                           flags.c ? OPEN_EXISTING : OPEN_ALWAYS,
-                           FILE_FLAG_BACKUP_SEMANTICS,
-                           NULL);
-        SetFileTime(hFile,
-                    NULL,
-                    flags.a ? &atime : NULL,
-                    flags.m ? &mtime : NULL);
-        CloseHandle(hFile);
+        failures += touch_each(nextOperand, &args, flags, pa, pm, 0);
     }
+    failures += args.failures();
 
-    return 0;
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
 }
 
+
+#if !defined(UTILS_MULTICALL)
+int main (int argc, char** argv)
+{
+    return touch_main(argc, argv);
+}
+#endif
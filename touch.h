@@ -0,0 +1,177 @@
+#ifndef TOUCH_H_INCLUDED
+#define TOUCH_H_INCLUDED
+
+/**
+ * touch.h - platform interface of touch(1).
+ * free to distribute under the GPL license.
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ *
+ * touch.cpp parses the options, timestamp.cpp the time operand;
+ * the backend sets the timestamps: touch_posix.cpp on GNU/Linux and
+ * other POSIX systems, touch_win32.cpp on Microsoft Windows.
+ * touch_bulk.cpp spreads long file lists, directory trees and timestamp
+ * manifests over threads.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include "timestamp.h"
+
+
+typedef struct
+{
+    bool a;
+    bool c;
+    bool m;
+    bool R;
+} flags_st;
+
+
+/**
+ * the nsec of a timestamp standing for the current time.
+ * the backend lets the system take the time as it sets it (UTIME_NOW on
+ * POSIX systems), which needs only write access to the file, where an
+ * explicit time needs its ownership.
+ */
+const long TOUCH_NOW = -1;
+
+/**
+ * mark `ts' as the current time.
+ */
+inline void touch_now(timestamp_st& ts)
+{
+    ts.sec = 0;
+    ts.nsec = TOUCH_NOW;
+}
+
+/**
+ * get the access and modification times of `path'.
+ */
+bool touch_stat(const char *path, timestamp_st& atime, timestamp_st& mtime);
+
+/**
+ * set the access and modification times of `path', leaving a time alone
+ * if its pointer is NULL. a missing file is created, unless flags.c is set
+ * (then it is skipped, which is not an error).
+ */
+bool touch_file(const char *path,
+                const flags_st& flags,
+                const timestamp_st *atime,
+                const timestamp_st *mtime);
+
+/**
+ * describe the error of the last failed call in this thread;
+ * the text stays valid until the thread calls it again.
+ */
+const char *touch_strerror();
+
+
+/**
+ * a file met in a directory walk.
+ */
+typedef struct
+{
+    const char *path;   /* path from the root of the walk */
+    const char *name;   /* last component of path */
+    int dir;            /* descriptor of the parent directory, or -1 */
+    bool link;          /* a symbolic link (not followed) */
+    const timestamp_st *atime;  /* of a directory, before the walk read it; */
+    const timestamp_st *mtime;  /* NULL if unknown */
+} entry_st;
+
+/**
+ * return false if the entry failed (after reporting it).
+ */
+typedef bool (*visit_fn)(const entry_st& entry, void *ctx);
+
+/**
+ * call `visit' for every file and directory below the directory `root'
+ * (not for `root' itself), concurrently from up to `threads' threads.
+ * a directory is visited after everything below it, since reading it
+ * sets its access time. symbolic links are reported, not followed.
+ * nothing happens if `root' is not a directory or does not exist.
+ * returns the number of failed entries, including unreadable directories.
+ */
+int touch_walk(const char *root, unsigned threads, visit_fn visit, void *ctx);
+
+/**
+ * touch_stat for an entry of a walk; a directory has the times it had
+ * before the walk read it (entry.atime and entry.mtime) if they are known.
+ */
+bool touch_stat_entry(const entry_st& entry,
+                      timestamp_st& atime,
+                      timestamp_st& mtime);
+
+/**
+ * touch_file for an entry of a walk, which already exists.
+ */
+bool touch_entry(const entry_st& entry,
+                 const timestamp_st *atime,
+                 const timestamp_st *mtime);
+
+
+/**
+ * report that `path' could not be touched, with touch_strerror().
+ */
+void touch_error(const char *path);
+
+/**
+ * touch every name in the NUL-delimited list `in'; with flags.R, also
+ * everything below each directory named (see touch_tree).
+ * returns the number of files that could not be touched.
+ */
+int touch_list(FILE *in,
+               const flags_st& flags,
+               const timestamp_st *atime,
+               const timestamp_st *mtime,
+               unsigned threads);
+
+/**
+ * return the next name, or NULL after the last one.
+ */
+typedef const char *(*next_fn)(void *ctx);
+
+/**
+ * touch every name given by `next'; a name only needs to stay valid until
+ * the next call. the pool of threads is started only for long lists.
+ * returns the number of files that could not be touched.
+ */
+int touch_each(next_fn next,
+               void *ctx,
+               const flags_st& flags,
+               const timestamp_st *atime,
+               const timestamp_st *mtime,
+               unsigned threads);
+
+/**
+ * touch `root' and, if it is a directory, everything below it.
+ * returns the number of files that could not be touched.
+ */
+int touch_tree(const char *root,
+               const flags_st& flags,
+               const timestamp_st *atime,
+               const timestamp_st *mtime,
+               unsigned threads);
+
+/**
+ * set each file named in the manifest `file' to its own recorded times.
+ * a manifest holds one record per line: path<TAB>atime<TAB>mtime,
+ * each time being a signed decimal number of seconds since the epoch,
+ * with up to nine fraction digits (-1.5 is 1.5 seconds before it, as
+ * stat -c %.9Y prints it), or an ISO-8601 date and time
+ * (see timestamp_parse_iso).
+ * flags.a and flags.m select the times applied; flags.c skips missing files.
+ * returns the number of records that failed.
+ */
+int touch_manifest(const char *file,
+                   const flags_st& flags,
+                   unsigned threads);
+
+/**
+ * write a manifest record for `root' and for everything below it
+ * (except symbolic links, which touch_manifest would follow) to `out'.
+ * returns the number of files that could not be recorded.
+ */
+int touch_dump(const char *root, FILE *out, unsigned threads);
+
+#endif  /* TOUCH_H_INCLUDED */
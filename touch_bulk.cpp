@@ -0,0 +1,475 @@
+/**
+ * touch_bulk.cpp - touch(1) for long file lists and whole directory trees.
+ * names are read from a NUL-delimited list in chunks and touched by a pool
+ * of threads, which keeps many requests in flight on network file systems.
+ * a timestamp manifest is mapped into memory and applied in slices;
+ * its times may be epoch seconds or ISO-8601 dates (timestamp.cpp).
+ *
+ * free to distribute under the GPL license.
+ * if you have not received a copy of the license along with the code,
+ * confer to http://www.gnu.org/licenses/gpl.html
+ *
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ */
+
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include "mapfile.h"
+#include "threadpool.h"
+#include "touch.h"
+
+
+/* bytes of the list handed to one task. */
+static const size_t ChunkSize = 64 * 1024;
+
+
+struct Job
+{
+    const flags_st *flags;
+    const timestamp_st *atime;
+    const timestamp_st *mtime;
+    std::atomic<int> failures;
+};
+
+
+/**
+ * touch the NUL-terminated names packed in `names'.
+ */
+static void touchNames(Job& job, const std::string& names)
+{
+    const char *p = names.data();
+    const char *end = p + names.size();
+
+    while (p < end)
+    {
+        size_t len = strlen(p);
+        if (len && !touch_file(p, *job.flags, job.atime, job.mtime))
+        {
+            touch_error(p);
+            ++job.failures;
+        }
+        p += len + 1;
+    }
+}
+
+
+/**
+ * touch_tree for each of the NUL-terminated names packed in `names'.
+ */
+static void touchTrees(Job& job, const std::string& names, unsigned threads)
+{
+    const char *p = names.data();
+    const char *end = p + names.size();
+
+    while (p < end)
+    {
+        size_t len = strlen(p);
+        if (len)
+        {
+            job.failures += touch_tree(p, *job.flags, job.atime, job.mtime,
+                                       threads);
+        }
+        p += len + 1;
+    }
+}
+
+
+int touch_list(FILE *in,
+               const flags_st& flags,
+               const timestamp_st *atime,
+               const timestamp_st *mtime,
+               unsigned threads)
+{
+    Job job;
+    job.flags = &flags;
+    job.atime = atime;
+    job.mtime = mtime;
+    job.failures = 0;
+
+    /* with -R, each tree is walked by a pool of its own instead. */
+    std::unique_ptr<ThreadPool> pool;
+    if (!flags.R) pool.reset(new ThreadPool(threads));
+    std::string chunk;
+    std::string rest;   /* a name cut by the end of the last read */
+    std::vector<char> buffer(ChunkSize);
+
+    for (;;)
+    {
+        size_t n = fread(&buffer[0], 1, buffer.size(), in);
+        if (n == 0) break;
+
+        /* hand over everything up to the last NUL. */
+        size_t whole = n;
+        while (whole && buffer[whole - 1] != '\0') --whole;
+        if (whole == 0)
+        {
+            rest.append(&buffer[0], n);
+            continue;
+        }
+
+        chunk.swap(rest);
+        chunk.append(&buffer[0], whole);
+        rest.assign(&buffer[0] + whole, n - whole);
+
+        if (!pool)
+        {
+            touchTrees(job, chunk, threads);
+            chunk.clear();
+            continue;
+        }
+
+        /* keep a few chunks queued per thread, not the whole list. */
+        pool->throttle(4 * pool->size());
+        Job *j = &job;
+        pool->submit([j, chunk] { touchNames(*j, chunk); });
+        chunk.clear();
+    }
+
+    if (ferror(in))
+    {
+        fprintf(stderr, "touch: error reading the file list.\n");
+        ++job.failures;
+    }
+
+    if (!rest.empty())
+    {
+        rest += '\0';
+        if (pool) touchNames(job, rest);
+        else touchTrees(job, rest, threads);
+    }
+
+    if (pool) pool->wait();
+    return job.failures;
+}
+
+
+int touch_each(next_fn next,
+               void *ctx,
+               const flags_st& flags,
+               const timestamp_st *atime,
+               const timestamp_st *mtime,
+               unsigned threads)
+{
+    Job job;
+    job.flags = &flags;
+    job.atime = atime;
+    job.mtime = mtime;
+    job.failures = 0;
+
+    std::unique_ptr<ThreadPool> pool;
+    std::string chunk;
+
+    for (const char *name; (name = next(ctx)); )
+    {
+        chunk.append(name, strlen(name) + 1);
+        if (chunk.size() < ChunkSize) continue;
+
+        /* a long list: from here on, let the pool touch it. */
+        if (!pool) pool.reset(new ThreadPool(threads));
+        pool->throttle(4 * pool->size());
+        Job *j = &job;
+        pool->submit([j, chunk] { touchNames(*j, chunk); });
+        chunk.clear();
+    }
+
+    touchNames(job, chunk);
+    if (pool) pool->wait();
+    return job.failures;
+}
+
+
+static bool touchEntry(const entry_st& entry, void *ctx)
+{
+    Job *job = static_cast<Job *>(ctx);
+    if (touch_entry(entry, job->atime, job->mtime)) return true;
+
+    touch_error(entry.path);
+    return false;
+}
+
+
+int touch_tree(const char *root,
+               const flags_st& flags,
+               const timestamp_st *atime,
+               const timestamp_st *mtime,
+               unsigned threads)
+{
+    Job job;
+    job.flags = &flags;
+    job.atime = atime;
+    job.mtime = mtime;
+    job.failures = 0;
+
+    /* the root last, after the walk has read it. */
+    int failures = touch_walk(root, threads, touchEntry, &job);
+    if (!touch_file(root, flags, atime, mtime))
+    {
+        touch_error(root);
+        ++failures;
+    }
+    return failures;
+}
+
+
+/**
+ * parse the signed decimal "[-]sec[.fraction]" at `p', leaving `p' past it.
+ */
+static bool parseTime(const char *&p, const char *end, timestamp_st& ts)
+{
+    bool negative = (p < end && *p == '-');
+    if (negative) ++p;
+    if (p == end || *p < '0' || *p > '9') return false;
+
+    int64_t sec = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        if (sec > (INT64_MAX - 9) / 10) return false;
+        sec = sec * 10 + (*p++ - '0');
+    }
+
+    long nsec = 0;
+    if (p < end && *p == '.')
+    {
+        int digits = 0;
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p, ++digits)
+        {
+            if (digits == 9) return false;
+            nsec = nsec * 10 + (*p - '0');
+        }
+        if (digits == 0) return false;
+        for (; digits < 9; ++digits) nsec *= 10;
+    }
+
+    /* -1.5 is {-2 s, 500000000 ns}, as in timespec. */
+    ts.sec = negative ? -sec : sec;
+    ts.nsec = nsec;
+    if (negative && nsec)
+    {
+        --ts.sec;
+        ts.nsec = 1000000000 - nsec;
+    }
+    return true;
+}
+
+
+/**
+ * parse the time field [p, end): epoch seconds, or an ISO-8601 date and time.
+ */
+static bool parseField(const char *p, const char *end, timestamp_st& ts)
+{
+    const char *q = p;
+    if (parseTime(q, end, ts) && q == end) return true;
+
+    datetime_st dt;
+    return (timestamp_parse_iso(p, end - p, dt) && timestamp_convert(dt, ts));
+}
+
+
+struct Manifest
+{
+    const char *data;
+    const char *file;
+    const flags_st *flags;
+    std::atomic<int> failures;
+};
+
+
+/**
+ * apply the records in [p, end), which starts and ends on a line boundary.
+ */
+static void applyRecords(Manifest& manifest, const char *p, const char *end)
+{
+    char path[4096];
+
+    while (p < end)
+    {
+        const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+        if (eol == NULL) eol = end;
+
+        const char *line = p;
+        const char *last = (eol > p && eol[-1] == '\r') ? eol - 1 : eol;
+        p = eol + 1;
+        if (line == last) continue;
+
+        const char *tab = static_cast<const char *>(memchr(line, '\t', last - line));
+        const char *tab2 = tab
+                         ? static_cast<const char *>(memchr(tab + 1, '\t', last - tab - 1))
+                         : NULL;
+        timestamp_st atime, mtime;
+
+        if (tab == NULL || tab == line || tab2 == NULL ||
+            !parseField(tab + 1, tab2, atime) ||
+            !parseField(tab2 + 1, last, mtime))
+        {
+            fprintf(stderr,
+                    "touch: %s: malformed record at byte %lu.\n",
+                    manifest.file,
+                    (unsigned long)(line - manifest.data));
+            ++manifest.failures;
+            continue;
+        }
+
+        size_t len = tab - line;
+        if (len >= sizeof path)
+        {
+            fprintf(stderr,
+                    "touch: %s: path too long at byte %lu.\n",
+                    manifest.file,
+                    (unsigned long)(line - manifest.data));
+            ++manifest.failures;
+            continue;
+        }
+        memcpy(path, line, len);
+        path[len] = '\0';
+
+        const flags_st& flags = *manifest.flags;
+        if (!touch_file(path,
+                        flags,
+                        flags.a ? &atime : NULL,
+                        flags.m ? &mtime : NULL))
+        {
+            touch_error(path);
+            ++manifest.failures;
+        }
+    }
+}
+
+
+int touch_manifest(const char *file,
+                   const flags_st& flags,
+                   unsigned threads)
+{
+    mapfile_st map;
+    if (!map_file(file, map))
+    {
+        fprintf(stderr,
+                "touch: error opening '%s': %s.\n",
+                file,
+                touch_strerror());
+        return 1;
+    }
+
+    Manifest manifest;
+    manifest.data = map.data;
+    manifest.file = file;
+    manifest.flags = &flags;
+    manifest.failures = 0;
+
+    {
+        ThreadPool pool(threads);
+
+        /* a few slices per thread, cut after a newline. */
+        size_t slices = 8 * pool.size();
+        if (map.size / slices < ChunkSize) slices = map.size / ChunkSize + 1;
+
+        const char *end = map.data + map.size;
+        const char *begin = map.data;
+        for (size_t i = 1; i <= slices && begin < end; ++i)
+        {
+            const char *cut = map.data + map.size / slices * i;
+            if (i == slices || cut >= end)
+            {
+                cut = end;
+            }
+            else
+            {
+                if (cut < begin) cut = begin;
+                cut = static_cast<const char *>(memchr(cut, '\n', end - cut));
+                cut = cut ? cut + 1 : end;
+            }
+
+            Manifest *m = &manifest;
+            pool.submit([m, begin, cut] { applyRecords(*m, begin, cut); });
+            begin = cut;
+        }
+        pool.wait();
+    }
+
+    unmap_file(map);
+    return manifest.failures;
+}
+
+
+/**
+ * write `ts' to `out' as the signed decimal read by parseTime.
+ */
+static int formatTime(char *out, size_t size, const timestamp_st& ts)
+{
+    const char *sign = "";
+    unsigned long long sec = (unsigned long long)ts.sec;
+    long nsec = ts.nsec;
+    if (ts.sec < 0)
+    {
+        sign = "-";
+        sec = 0 - sec;
+        if (nsec)
+        {
+            --sec;
+            nsec = 1000000000 - nsec;
+        }
+    }
+    return snprintf(out, size, "%s%llu.%09ld", sign, sec, nsec);
+}
+
+
+static bool dumpRecord(const char *path,
+                       const timestamp_st& atime,
+                       const timestamp_st& mtime,
+                       FILE *out)
+{
+    if (strpbrk(path, "\t\n"))
+    {
+        fprintf(stderr,
+                "touch: cannot record '%s': tab or newline in the name.\n",
+                path);
+        return false;
+    }
+
+    /* one write per record, so that threads do not interleave lines. */
+    char a[32], m[32];
+    formatTime(a, sizeof a, atime);
+    formatTime(m, sizeof m, mtime);
+
+    char record[4096 + 64];
+    int len = snprintf(record, sizeof record, "%s\t%s\t%s\n", path, a, m);
+    if (len < 0 || (size_t)len >= sizeof record)
+    {
+        fprintf(stderr, "touch: cannot record '%s': path too long.\n", path);
+        return false;
+    }
+    fwrite(record, 1, len, out);
+    return true;
+}
+
+
+static bool dumpEntry(const entry_st& entry, void *ctx)
+{
+    if (entry.link) return true;
+
+    timestamp_st atime, mtime;
+    if (!touch_stat_entry(entry, atime, mtime))
+    {
+        touch_error(entry.path);
+        return false;
+    }
+    return dumpRecord(entry.path, atime, mtime, static_cast<FILE *>(ctx));
+}
+
+
+int touch_dump(const char *root, FILE *out, unsigned threads)
+{
+    timestamp_st atime, mtime;
+    if (!touch_stat(root, atime, mtime))
+    {
+        touch_error(root);
+        return 1;
+    }
+
+    int failures = dumpRecord(root, atime, mtime, out) ? 0 : 1;
+    return failures + touch_walk(root, threads, dumpEntry, out);
+}
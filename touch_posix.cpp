@@ -0,0 +1,409 @@
+/**
+ * touch_posix.cpp - touch(1) backend for GNU/Linux and other POSIX systems.
+ * times are set by path with utimensat(2), without opening the file.
+ * directory walks read each directory through its descriptor
+ * (getdents64(2) on Linux) and touch entries relative to it.
+ *
+ * free to distribute under the GPL license.
+ * if you have not received a copy of the license along with the code,
+ * confer to http://www.gnu.org/licenses/gpl.html
+ *
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ */
+
+
+#include <sys/stat.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include "threadpool.h"
+#include "touch.h"
+
+#if defined(__linux__)
+#   include <sys/syscall.h>
+#endif
+
+#if defined(__APPLE__)
+#   define st_atim st_atimespec
+#   define st_mtim st_mtimespec
+#endif
+
+
+bool touch_stat(const char *path, timestamp_st& atime, timestamp_st& mtime)
+{
+    struct stat buf;
+    if (stat(path, &buf)) return false;
+
+    atime.sec = buf.st_atim.tv_sec;
+    atime.nsec = buf.st_atim.tv_nsec;
+    mtime.sec = buf.st_mtim.tv_sec;
+    mtime.nsec = buf.st_mtim.tv_nsec;
+    return true;
+}
+
+
+static void totimespec(const timestamp_st *ts, struct timespec& spec)
+{
+    if (ts && ts->nsec == TOUCH_NOW)
+    {
+        spec.tv_sec = 0;
+        spec.tv_nsec = UTIME_NOW;
+    }
+    else if (ts)
+    {
+        spec.tv_sec = (time_t)ts->sec;
+        spec.tv_nsec = ts->nsec;
+    }
+    else
+    {
+        spec.tv_sec = 0;
+        spec.tv_nsec = UTIME_OMIT;
+    }
+}
+
+
+bool touch_file(const char *path,
+                const flags_st& flags,
+                const timestamp_st *atime,
+                const timestamp_st *mtime)
+{
+    struct timespec times[2];
+    totimespec(atime, times[0]);
+    totimespec(mtime, times[1]);
+
+    /* the common case: the file exists, so no descriptor is needed. */
+    if (!utimensat(AT_FDCWD, path, times, 0)) return true;
+    if (errno != ENOENT) return false;
+    if (flags.c) return true;
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_NOCTTY | O_NONBLOCK, 0666);
+    if (fd < 0) return false;
+
+    bool ok = !futimens(fd, times);
+    int err = errno;
+    close(fd);
+    errno = err;
+    return ok;
+}
+
+
+const char *touch_strerror()
+{
+    return strerror(errno);
+}
+
+
+bool touch_entry(const entry_st& entry,
+                 const timestamp_st *atime,
+                 const timestamp_st *mtime)
+{
+    struct timespec times[2];
+    totimespec(atime, times[0]);
+    totimespec(mtime, times[1]);
+
+    return !utimensat(entry.dir < 0 ? AT_FDCWD : entry.dir,
+                      entry.dir < 0 ? entry.path : entry.name,
+                      times,
+                      entry.link ? AT_SYMLINK_NOFOLLOW : 0);
+}
+
+
+bool touch_stat_entry(const entry_st& entry,
+                      timestamp_st& atime,
+                      timestamp_st& mtime)
+{
+    if (entry.atime && entry.mtime)
+    {
+        atime = *entry.atime;
+        mtime = *entry.mtime;
+        return true;
+    }
+
+    struct stat buf;
+    if (fstatat(entry.dir < 0 ? AT_FDCWD : entry.dir,
+                entry.dir < 0 ? entry.path : entry.name,
+                &buf,
+                entry.link ? AT_SYMLINK_NOFOLLOW : 0))
+    {
+        return false;
+    }
+
+    atime.sec = buf.st_atim.tv_sec;
+    atime.nsec = buf.st_atim.tv_nsec;
+    mtime.sec = buf.st_mtim.tv_sec;
+    mtime.nsec = buf.st_mtim.tv_nsec;
+    return true;
+}
+
+
+/**
+ * read the entries of an open directory, without following its name again.
+ * the buffer is on the heap: a full queue makes the walk recurse, once
+ * per level of the tree.
+ */
+class DirReader
+{
+public:
+    explicit DirReader(int fd)
+        : fd_(fd),
+          error_(0),
+#if defined(__linux__)
+          len_(0),
+          pos_(0),
+          buffer_(new uint64_t[BufferSize / sizeof(uint64_t)])
+#else
+          dir_(NULL)
+#endif
+    {
+    }
+
+    ~DirReader()
+    {
+#if !defined(__linux__)
+        if (dir_) closedir(dir_);   /* closes a duplicate of fd_ */
+#endif
+    }
+
+    /**
+     * get the next entry other than "." and "..";
+     * `type' is a DT_* constant, possibly DT_UNKNOWN.
+     * returns false at the end, or on error (see error()).
+     */
+    bool next(const char *&name, unsigned char& type)
+    {
+        for (;;)
+        {
+#if defined(__linux__)
+            if (pos_ >= len_)
+            {
+                long n = syscall(SYS_getdents64, fd_, buffer_.get(), BufferSize);
+                if (n <= 0)
+                {
+                    if (n < 0) error_ = errno;
+                    return false;
+                }
+                len_ = n;
+                pos_ = 0;
+            }
+
+            struct dirent64_st
+            {
+                uint64_t d_ino;
+                int64_t d_off;
+                unsigned short d_reclen;
+                unsigned char d_type;
+                char d_name[1];
+            };
+            const dirent64_st *ent =
+                reinterpret_cast<const dirent64_st *>(
+                    reinterpret_cast<const char *>(buffer_.get()) + pos_);
+            pos_ += ent->d_reclen;
+            name = ent->d_name;
+            type = ent->d_type;
+#else
+            if (!dir_)
+            {
+                int fd = dup(fd_);
+                if (fd < 0 || !(dir_ = fdopendir(fd)))
+                {
+                    error_ = errno;
+                    if (fd >= 0) close(fd);
+                    return false;
+                }
+            }
+
+            errno = 0;
+            struct dirent *ent = readdir(dir_);
+            if (!ent)
+            {
+                error_ = errno;
+                return false;
+            }
+            name = ent->d_name;
+#   if defined(DT_UNKNOWN)
+            type = ent->d_type;
+#   else
+            type = 0;
+#   endif
+#endif
+            if (name[0] == '.' && (!name[1] || (name[1] == '.' && !name[2])))
+            {
+                continue;
+            }
+            return true;
+        }
+    }
+
+    int error() const { return error_; }
+
+private:
+    int fd_;
+    int error_;
+#if defined(__linux__)
+    enum { BufferSize = 16384 };
+
+    long len_;
+    long pos_;
+    std::unique_ptr<uint64_t[]> buffer_;  /* aligned for the records */
+#else
+    DIR *dir_;
+#endif
+};
+
+
+/**
+ * shared state of a parallel walk.
+ * queued directories hold a descriptor each; past MaxQueued, a worker
+ * walks a subdirectory itself instead of queueing it.
+ */
+struct Walk
+{
+    enum { MaxQueued = 256 };
+
+    ThreadPool pool;
+    visit_fn visit;
+    void *ctx;
+    std::atomic<int> failures;
+    std::atomic<int> queued;
+
+    Walk(unsigned threads, visit_fn visit, void *ctx)
+        : pool(threads),
+          visit(visit),
+          ctx(ctx),
+          failures(0),
+          queued(0)
+    {
+    }
+};
+
+
+static void walkdir(Walk& walk, int fd, const std::string& path)
+{
+    DirReader reader(fd);
+    const char *name;
+    unsigned char type;
+    std::string child;
+
+    while (reader.next(name, type))
+    {
+        child.assign(path);
+        child += '/';
+        child += name;
+
+        struct stat buf;
+        bool stated = false;
+        if (type == DT_UNKNOWN)
+        {
+            stated = !fstatat(fd, name, &buf, AT_SYMLINK_NOFOLLOW);
+            if (stated)
+            {
+                type = S_ISDIR(buf.st_mode) ? DT_DIR
+                     : S_ISLNK(buf.st_mode) ? DT_LNK
+                     : DT_REG;
+            }
+        }
+
+        entry_st entry = { child.c_str(), name, fd, type == DT_LNK,
+                           NULL, NULL };
+        if (type != DT_DIR)
+        {
+            if (!walk.visit(entry, walk.ctx)) ++walk.failures;
+            continue;
+        }
+
+        /**
+         * reading a directory sets its access time: visit it afterwards,
+         * with the times it had before.
+         */
+        timestamp_st times[2];
+        if (!stated) stated = !fstatat(fd, name, &buf, AT_SYMLINK_NOFOLLOW);
+        if (stated)
+        {
+            times[0].sec = buf.st_atim.tv_sec;
+            times[0].nsec = buf.st_atim.tv_nsec;
+            times[1].sec = buf.st_mtim.tv_sec;
+            times[1].nsec = buf.st_mtim.tv_nsec;
+            entry.atime = &times[0];
+            entry.mtime = &times[1];
+        }
+
+        int sub = openat(fd, name,
+                         O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (sub < 0)
+        {
+            touch_error(child.c_str());
+            ++walk.failures;
+            if (!walk.visit(entry, walk.ctx)) ++walk.failures;
+            continue;
+        }
+
+        if (++walk.queued <= Walk::MaxQueued)
+        {
+            /* `fd' may be closed first; a failed dup falls back to the path. */
+            int parent = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+            size_t base = child.size() - strlen(name);
+            Walk *w = &walk;
+            walk.pool.submit([w, sub, parent, child, base, stated, times]
+            {
+                walkdir(*w, sub, child);
+                close(sub);
+
+                entry_st entry = { child.c_str(), child.c_str() + base,
+                                   parent, false,
+                                   stated ? &times[0] : NULL,
+                                   stated ? &times[1] : NULL };
+                if (!w->visit(entry, w->ctx)) ++w->failures;
+                if (parent >= 0) close(parent);
+                --w->queued;
+            });
+        }
+        else
+        {
+            --walk.queued;
+            walkdir(walk, sub, child);
+            close(sub);
+            if (!walk.visit(entry, walk.ctx)) ++walk.failures;
+        }
+    }
+
+    if (reader.error())
+    {
+        errno = reader.error();
+        touch_error(path.empty() ? "/" : path.c_str());
+        ++walk.failures;
+    }
+}
+
+
+int touch_walk(const char *root, unsigned threads, visit_fn visit, void *ctx)
+{
+    int fd = open(root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        if (errno == ENOTDIR || errno == ENOENT) return 0;
+        touch_error(root);
+        return 1;
+    }
+
+    /* children are named path + '/' + name, so "/" becomes "". */
+    std::string path(root);
+    while (!path.empty() && path[path.size() - 1] == '/')
+    {
+        path.erase(path.size() - 1);
+    }
+
+    Walk walk(threads, visit, ctx);
+    walk.pool.submit([&walk, fd, &path]
+    {
+        walkdir(walk, fd, path);
+        close(fd);
+    });
+    walk.pool.wait();
+    return walk.failures;
+}
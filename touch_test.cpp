@@ -0,0 +1,284 @@
+/**
+ * touch_test.cpp - round trip of touch --dump-manifest and --manifest.
+ * builds a directory tree with distinct access and modification times,
+ * dumps its manifest, touches the whole tree to the current time, applies
+ * the manifest again, and checks that every file and directory has its
+ * own times back. reading a directory sets its access time, so the dump
+ * must record the times a directory had before the walk read it.
+ * for GNU/Linux and other POSIX systems.
+ *
+ * build: g++ -O2 -std=c++17 -pthread -DUTILS_MULTICALL touch_test.cpp \
+ *            touch.cpp touch_posix.cpp touch_bulk.cpp timestamp.cpp \
+ *            operands.cpp mapfile.cpp
+ *
+ * SYNOPSIS: touch_test [-d dirs] [-f files]
+ *
+ * the tree has `dirs' directories (default 300, more than the walk
+ * queues) of `files' files each (default 4), some of them nested.
+ *
+ * free to distribute under the GPL license.
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ */
+
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "utils.h"
+
+
+struct Node
+{
+    std::string path;
+    bool dir;
+    struct timespec atime;
+    struct timespec mtime;
+};
+
+
+/**
+ * the tree below `root', parents before children; every node gets times
+ * of its own, in 2001 for the access time (older than the modification
+ * time, so that reading a directory updates it even under relatime),
+ * and a few before the epoch.
+ */
+static std::vector<Node> makeNodes(const std::string& root,
+                                   unsigned long dirs, unsigned long files)
+{
+    std::vector<Node> nodes;
+    Node node = { root, true, { 0, 0 }, { 0, 0 } };
+    nodes.push_back(node);
+
+    unsigned long seed = 12345;
+    for (unsigned long d = 0; d < dirs; ++d)
+    {
+        /* every fourth directory is nested in the one before it. */
+        char name[32];
+        snprintf(name, sizeof name, "/d%lu", d);
+        node.path = (d % 4 && d > 0) ? nodes[nodes.size() - files - 1].path
+                                     : root;
+        node.path += name;
+        node.dir = true;
+        nodes.push_back(node);
+
+        std::string dir = node.path;
+        for (unsigned long f = 0; f < files; ++f)
+        {
+            snprintf(name, sizeof name, "/f%lu", f);
+            node.path = dir + name;
+            node.dir = false;
+            nodes.push_back(node);
+        }
+    }
+
+    for (std::size_t k = 0; k < nodes.size(); ++k)
+    {
+        seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+        long nsec = (long)(seed >> 20) % 1000000000;
+        nodes[k].atime.tv_sec = (k % 17 == 5) ? -86400 - (time_t)k
+                                              : 978307200 + (time_t)k * 60;
+        nodes[k].atime.tv_nsec = nsec;
+        nodes[k].mtime.tv_sec = 1000000000 + (time_t)k * 3600;
+        nodes[k].mtime.tv_nsec = (nsec * 7) % 1000000000;
+    }
+    return nodes;
+}
+
+
+static bool buildTree(const std::vector<Node>& nodes)
+{
+    for (std::size_t k = 0; k < nodes.size(); ++k)
+    {
+        const char *path = nodes[k].path.c_str();
+        if (nodes[k].dir ? mkdir(path, 0755) != 0
+                         : close(open(path, O_WRONLY | O_CREAT | O_EXCL, 0644)))
+        {
+            perror(path);
+            return false;
+        }
+    }
+
+    /* children first, since creating a file sets its directory's times. */
+    for (std::size_t k = nodes.size(); k-- > 0; )
+    {
+        struct timespec times[2] = { nodes[k].atime, nodes[k].mtime };
+        if (utimensat(AT_FDCWD, nodes[k].path.c_str(), times, 0))
+        {
+            perror(nodes[k].path.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+
+static void removeTree(const std::vector<Node>& nodes)
+{
+    for (std::size_t k = nodes.size(); k-- > 0; )
+    {
+        if (nodes[k].dir) rmdir(nodes[k].path.c_str());
+        else unlink(nodes[k].path.c_str());
+    }
+}
+
+
+/**
+ * run touch_main with `args', its standard output going to `out' if given.
+ */
+static int runTouch(std::vector<const char *> args, const char *out)
+{
+    args.insert(args.begin(), "touch");
+    args.push_back(NULL);
+
+    int saved = -1;
+    if (out)
+    {
+        fflush(stdout);
+        int fd = open(out, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            perror(out);
+            return EXIT_FAILURE;
+        }
+        saved = dup(STDOUT_FILENO);
+        dup2(fd, STDOUT_FILENO);
+        close(fd);
+    }
+
+    int status = touch_main((int)args.size() - 1,
+                            const_cast<char **>(&args[0]));
+
+    if (out)
+    {
+        fflush(stdout);
+        dup2(saved, STDOUT_FILENO);
+        close(saved);
+    }
+    return status;
+}
+
+
+/**
+ * compare the times of every node with its own. returns the number of
+ * differences.
+ */
+static unsigned long checkTree(const std::vector<Node>& nodes, const char *step)
+{
+    unsigned long bad = 0;
+    for (std::size_t k = 0; k < nodes.size(); ++k)
+    {
+        const Node& n = nodes[k];
+        struct stat buf;
+        if (lstat(n.path.c_str(), &buf))
+        {
+            perror(n.path.c_str());
+            ++bad;
+            continue;
+        }
+
+        if (buf.st_atim.tv_sec != n.atime.tv_sec ||
+            buf.st_atim.tv_nsec != n.atime.tv_nsec ||
+            buf.st_mtim.tv_sec != n.mtime.tv_sec ||
+            buf.st_mtim.tv_nsec != n.mtime.tv_nsec)
+        {
+            if (bad++ < 5)
+            {
+                fprintf(stderr,
+                        "touch_test: %s: %s%s has %lld.%09ld %lld.%09ld, "
+                        "not %lld.%09ld %lld.%09ld.\n",
+                        step, n.path.c_str(), n.dir ? "/" : "",
+                        (long long)buf.st_atim.tv_sec, buf.st_atim.tv_nsec,
+                        (long long)buf.st_mtim.tv_sec, buf.st_mtim.tv_nsec,
+                        (long long)n.atime.tv_sec, n.atime.tv_nsec,
+                        (long long)n.mtime.tv_sec, n.mtime.tv_nsec);
+            }
+        }
+    }
+    return bad;
+}
+
+
+static bool parseCount(const char *s, unsigned long& value)
+{
+    char *end = NULL;
+    value = strtoul(s, &end, 10);
+    return (*s && !*end);
+}
+
+
+int main(int argc, char **argv)
+{
+    unsigned long dirs = 300, files = 4;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        unsigned long value;
+        if (argv[i][0] != '-' || !argv[i][1] || argv[i][2] ||
+            i + 1 >= argc || !parseCount(argv[i + 1], value))
+        {
+            fprintf(stderr, "usage: touch_test [-d dirs] [-f files]\n");
+            return EXIT_FAILURE;
+        }
+
+        switch (argv[i++][1])
+        {
+            case 'd': dirs = value; break;
+            case 'f': files = value; break;
+            default:  fprintf(stderr, "usage: touch_test [-d dirs] [-f files]\n");
+                      return EXIT_FAILURE;
+        }
+    }
+
+    char temp[] = "/tmp/touch_test.XXXXXX";
+    if (!mkdtemp(temp))
+    {
+        perror("touch_test: mkdtemp");
+        return EXIT_FAILURE;
+    }
+    std::string base(temp);
+    std::string root = base + "/tree";
+    std::string manifest = base + "/manifest";
+
+    std::vector<Node> nodes = makeNodes(root, dirs, files);
+    unsigned long bad = 0;
+    int status = EXIT_SUCCESS;
+
+    if (!buildTree(nodes))
+    {
+        status = EXIT_FAILURE;
+    }
+    else if (runTouch({ "--dump-manifest", root.c_str() }, manifest.c_str()))
+    {
+        fprintf(stderr, "touch_test: --dump-manifest failed.\n");
+        status = EXIT_FAILURE;
+    }
+    else if (runTouch({ "-R", root.c_str() }, NULL))
+    {
+        fprintf(stderr, "touch_test: touch -R failed.\n");
+        status = EXIT_FAILURE;
+    }
+    else if (runTouch({ "--manifest", manifest.c_str() }, NULL))
+    {
+        fprintf(stderr, "touch_test: --manifest failed.\n");
+        status = EXIT_FAILURE;
+    }
+    else
+    {
+        bad = checkTree(nodes, "dump, touch -R, --manifest");
+        printf("%-30s %8lu files and directories, %lu differences\n",
+               "manifest round trip", (unsigned long)nodes.size(), bad);
+        if (bad) status = EXIT_FAILURE;
+    }
+
+    removeTree(nodes);
+    unlink(manifest.c_str());
+    rmdir(base.c_str());
+
+    if (status == EXIT_SUCCESS) printf("touch_test: all passed.\n");
+    return status;
+}
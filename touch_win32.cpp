@@ -0,0 +1,257 @@
+/**
+ * touch_win32.cpp - touch(1) backend for Microsoft Windows.
+ *
+ * free to distribute under the GPL license.
+ * if you have not received a copy of the license along with the code,
+ * confer to http://www.gnu.org/licenses/gpl.html
+ *
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ */
+
+
+#include <windows.h>
+#include <string>
+#include "touch.h"
+
+
+/* FILETIME counts 100-nanosecond intervals since 1601-01-01. */
+static const int64_t EpochOffset = 116444736000000000LL;
+
+
+static void tofiletime(const timestamp_st& ts, FILETIME& ft)
+{
+    if (ts.nsec == TOUCH_NOW)
+    {
+        GetSystemTimeAsFileTime(&ft);
+        return;
+    }
+
+    int64_t t = ts.sec * 10000000 + ts.nsec / 100 + EpochOffset;
+    ft.dwLowDateTime = (DWORD)t;
+    ft.dwHighDateTime = (DWORD)(t >> 32);
+}
+
+
+static void fromfiletime(const FILETIME& ft, timestamp_st& ts)
+{
+    int64_t t = ((int64_t)ft.dwHighDateTime << 32 | ft.dwLowDateTime) - EpochOffset;
+    int64_t rem = t % 10000000;
+    if (rem < 0) rem += 10000000;
+    ts.sec = (t - rem) / 10000000;
+    ts.nsec = (long)(rem * 100);
+}
+
+
+/**
+ * get the times of `path'; with `link', of a reparse point itself.
+ */
+static bool statTimes(const char *path,
+                      bool link,
+                      timestamp_st& atime,
+                      timestamp_st& mtime)
+{
+    HANDLE hFile = CreateFile(path,
+                              GENERIC_READ,
+                              FILE_SHARE_READ,
+                              NULL,
+                              OPEN_EXISTING,
+                              FILE_FLAG_BACKUP_SEMANTICS |
+                              (link ? FILE_FLAG_OPEN_REPARSE_POINT : 0),
+                              NULL);
+    if (hFile == INVALID_HANDLE_VALUE) return false;
+
+    FILETIME fta, ftm;
+    BOOL ok = GetFileTime(hFile, NULL, &fta, &ftm);
+    CloseHandle(hFile);
+    if (!ok) return false;
+
+    fromfiletime(fta, atime);
+    fromfiletime(ftm, mtime);
+    return true;
+}
+
+
+bool touch_stat(const char *path, timestamp_st& atime, timestamp_st& mtime)
+{
+    return statTimes(path, false, atime, mtime);
+}
+
+
+bool touch_file(const char *path,
+                const flags_st& flags,
+                const timestamp_st *atime,
+                const timestamp_st *mtime)
+{
+    FILETIME fta, ftm;
+    if (atime) tofiletime(*atime, fta);
+    if (mtime) tofiletime(*mtime, ftm);
+
+    HANDLE hFile = CreateFile(path,
+                              GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              NULL,
+                              flags.c ? OPEN_EXISTING : OPEN_ALWAYS,
+                              FILE_FLAG_BACKUP_SEMANTICS,
+                              NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        DWORD err = GetLastError();
+        return (flags.c && (err == ERROR_FILE_NOT_FOUND ||
+                            err == ERROR_PATH_NOT_FOUND));
+    }
+
+    BOOL ok = SetFileTime(hFile,
+                          NULL,
+                          atime ? &fta : NULL,
+                          mtime ? &ftm : NULL);
+    DWORD err = GetLastError();
+    CloseHandle(hFile);
+    SetLastError(err);
+    return (ok != FALSE);
+}
+
+
+const char *touch_strerror()
+{
+    /* one buffer per thread: the pools report errors concurrently. */
+    static thread_local char message[256];
+    DWORD len = FormatMessageA(FORMAT_MESSAGE_FROM_SYSTEM |
+                               FORMAT_MESSAGE_IGNORE_INSERTS,
+                               NULL,
+                               GetLastError(),
+                               0,
+                               message,
+                               sizeof message,
+                               NULL);
+
+    /* drop the trailing ".\r\n". */
+    while (len && (message[len - 1] == '\n' || message[len - 1] == '\r' ||
+                   message[len - 1] == '.'))
+    {
+        message[--len] = '\0';
+    }
+    return message;
+}
+
+
+/**
+ * a junction or symbolic link is touched itself, not followed,
+ * as utimensat(AT_SYMLINK_NOFOLLOW) does in touch_posix.cpp.
+ */
+bool touch_entry(const entry_st& entry,
+                 const timestamp_st *atime,
+                 const timestamp_st *mtime)
+{
+    FILETIME fta, ftm;
+    if (atime) tofiletime(*atime, fta);
+    if (mtime) tofiletime(*mtime, ftm);
+
+    HANDLE hFile = CreateFile(entry.path,
+                              GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              NULL,
+                              OPEN_EXISTING,
+                              FILE_FLAG_BACKUP_SEMANTICS |
+                              (entry.link ? FILE_FLAG_OPEN_REPARSE_POINT : 0),
+                              NULL);
+    if (hFile == INVALID_HANDLE_VALUE) return false;
+
+    BOOL ok = SetFileTime(hFile,
+                          NULL,
+                          atime ? &fta : NULL,
+                          mtime ? &ftm : NULL);
+    DWORD err = GetLastError();
+    CloseHandle(hFile);
+    SetLastError(err);
+    return (ok != FALSE);
+}
+
+
+bool touch_stat_entry(const entry_st& entry,
+                      timestamp_st& atime,
+                      timestamp_st& mtime)
+{
+    if (entry.atime && entry.mtime)
+    {
+        atime = *entry.atime;
+        mtime = *entry.mtime;
+        return true;
+    }
+    return statTimes(entry.path, entry.link, atime, mtime);
+}
+
+
+/**
+ * walk one directory and, depth first, its subdirectories,
+ * visiting each subdirectory after its walk.
+ */
+static int walkdir(const std::string& path, visit_fn visit, void *ctx)
+{
+    std::string spec(path);
+    spec += "\\*";
+
+    WIN32_FIND_DATAA data;
+    HANDLE hFind = FindFirstFileA(spec.c_str(), &data);
+    if (hFind == INVALID_HANDLE_VALUE)
+    {
+        touch_error(path.c_str());
+        return 1;
+    }
+
+    int failures = 0;
+    do
+    {
+        const char *name = data.cFileName;
+        if (name[0] == '.' && (!name[1] || (name[1] == '.' && !name[2])))
+        {
+            continue;
+        }
+
+        std::string child(path);
+        child += '\\';
+        child += name;
+
+        bool link = (data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0;
+        entry_st entry = { child.c_str(), name, -1, link, NULL, NULL };
+
+        /* take the times of a directory before reading it sets them. */
+        timestamp_st times[2];
+        if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && !link)
+        {
+            WIN32_FILE_ATTRIBUTE_DATA info;
+            if (GetFileAttributesExA(child.c_str(), GetFileExInfoStandard, &info))
+            {
+                fromfiletime(info.ftLastAccessTime, times[0]);
+                fromfiletime(info.ftLastWriteTime, times[1]);
+                entry.atime = &times[0];
+                entry.mtime = &times[1];
+            }
+            failures += walkdir(child, visit, ctx);
+        }
+
+        if (!visit(entry, ctx)) ++failures;
+    } while (FindNextFileA(hFind, &data));
+
+    FindClose(hFind);
+    return failures;
+}
+
+
+int touch_walk(const char *root, unsigned threads, visit_fn visit, void *ctx)
+{
+    (void)threads;  /* the walk is serial here. */
+
+    DWORD attrs = GetFileAttributesA(root);
+    if (attrs == INVALID_FILE_ATTRIBUTES || !(attrs & FILE_ATTRIBUTE_DIRECTORY))
+    {
+        return 0;
+    }
+
+    std::string path(root);
+    while (!path.empty() &&
+           (path[path.size() - 1] == '\\' || path[path.size() - 1] == '/'))
+    {
+        path.erase(path.size() - 1);
+    }
+    return walkdir(path, visit, ctx);
+}
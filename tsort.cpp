@@ -15,14 +15,14 @@
 #include <cstdlib>
 #include <algorithm>
 #include <functional>
-#include <iostream>
-#include <iterator>
 #include <list>
 #include <map>
 #include <set>
 #include <string>
 #include <utility>
 #include <vector>
+#include "output.h"
+#include "utils.h"
 
 
 struct Graph
@@ -176,13 +176,14 @@ const bool tsort(Graph& graph, std::list<Graph::Node::Key>& order)
 #define Q(x) #x
 #define QQ(x) Q(x)
 
-int main(int argc, char **argv)
+int tsort_main(int argc, char **argv)
 {
-    if (argv[1])
+    FILE *in = stdin;
+    if (argc > 1 && argv[1])
     {
-        if (!freopen(argv[1], "r", stdin))
+        if (!(in = fopen(argv[1], "r")))
         {
-            exit(EXIT_FAILURE);
+            return EXIT_FAILURE;
         }
     }
 
@@ -190,7 +191,7 @@ int main(int argc, char **argv)
     std::list<Graph::Node::Key> order;
 
     char left[BUFSIZ], right[BUFSIZ];
-    while (fscanf(stdin,
+    while (fscanf(in,
                   "%" QQ(BUFSIZ) "s"
                   "%" QQ(BUFSIZ) "s",
                   left,
@@ -207,13 +208,27 @@ int main(int argc, char **argv)
         }
     }
 
+    if (in != stdin) fclose(in);
+
+    Output out(stdout);
     if (tsort(graph, order))
     {
-        std::copy(order.begin(),
-                  order.end(),
-                  std::ostream_iterator<std::string>(std::cout, "\n"));
+        for (std::list<Graph::Node::Key>::const_iterator it = order.begin();
+             it != order.end();
+             ++it)
+        {
+            out.line(*it);
+        }
     }
 
-    return 0;
+    return out.flush() ? 0 : EXIT_FAILURE;
+}
+
+
+#if !defined(UTILS_MULTICALL)
+int main(int argc, char **argv)
+{
+    return tsort_main(argc, argv);
 }
+#endif
 
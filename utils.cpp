@@ -0,0 +1,103 @@
+/**
+ * utils - touch, tsort and which in a single multi-call program.
+ * a portable C++ implementation for Microsoft Windows and GNU/Linux.
+ *
+ * the utility to run is named by the program name, so that links named
+ * touch, tsort and which all run it, or else by the first argument:
+ *
+ *   utils which -a ls
+ *
+ * the utilities share one copy of the option parser, the operand reader,
+ * the output writer and the file helpers, and none of them brings iostream
+ * in. linked statically, the program starts without resolving any shared
+ * library, which is what a script running it many times waits for:
+ *
+ *   g++ -std=c++17 -O2 -static -pthread -DUTILS_MULTICALL -o utils \
+ *       utils.cpp touch.cpp touch_posix.cpp touch_bulk.cpp timestamp.cpp \
+ *       tsort.cpp which.cpp resolve.cpp operands.cpp mapfile.cpp
+ *   for u in touch tsort which; do ln -s utils $u; done
+ *
+ * (on Windows, touch_win32.cpp replaces touch_posix.cpp.)
+ *
+ * free to distribute under the GPL license.
+ * if you have not received a copy of the license along with the code,
+ * confer to http://www.gnu.org/licenses/gpl.html
+ *
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "utils.h"
+
+
+typedef struct
+{
+    const char *name;
+    int (*main)(int argc, char **argv);
+} applet_st;
+
+static const applet_st applets[] =
+{
+    { "touch", touch_main },
+    { "tsort", tsort_main },
+    { "which", which_main }
+};
+
+
+/**
+ * the utility called `name', with any directory and ".exe" left out.
+ */
+static const applet_st *find(const char *name)
+{
+    const char *base = name;
+    for (const char *p = name; *p; ++p)
+    {
+        if (*p == '/' || *p == '\\') base = p + 1;
+    }
+
+    size_t len = strlen(base);
+#if defined(_WIN32)
+    if (len > 4 && _stricmp(base + len - 4, ".exe") == 0) len -= 4;
+#endif
+
+    for (size_t i = 0; i < sizeof applets / sizeof applets[0]; ++i)
+    {
+        const char *applet = applets[i].name;
+        if (strlen(applet) == len && strncmp(applet, base, len) == 0)
+        {
+            return &applets[i];
+        }
+    }
+    return NULL;
+}
+
+
+static void usage()
+{
+    fprintf(stderr, "Usage: utils <utility> [arguments...]\n"
+                    "utilities:");
+    for (size_t i = 0; i < sizeof applets / sizeof applets[0]; ++i)
+    {
+        fprintf(stderr, " %s", applets[i].name);
+    }
+    fprintf(stderr, "\n");
+}
+
+
+int main (int argc, char** argv)
+{
+    const applet_st *applet = argv[0] ? find(argv[0]) : NULL;
+    if (applet) return applet->main(argc, argv);
+
+    /* run as utils itself: the utility comes next. */
+    if (argc < 2 || !(applet = find(argv[1])))
+    {
+        if (argc >= 2) fprintf(stderr, "utils: unknown utility '%s'.\n", argv[1]);
+        usage();
+        return EXIT_FAILURE;
+    }
+    return applet->main(argc - 1, argv + 1);
+}
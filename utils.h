@@ -0,0 +1,21 @@
+#ifndef UTILS_H_INCLUDED
+#define UTILS_H_INCLUDED
+
+/**
+ * utils.h - the entry points of the utilities.
+ * free to distribute under the GPL license.
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ *
+ * each utility is built as a program of its own, or, with UTILS_MULTICALL
+ * defined, linked into the multi-call program `utils' (see utils.cpp).
+ * either way its entry point may also be called in process: it keeps no
+ * state between calls, never calls exit(), and flushes its output before
+ * it returns the exit status.
+ */
+
+
+int touch_main(int argc, char **argv);
+int tsort_main(int argc, char **argv);
+int which_main(int argc, char **argv);
+
+#endif  /* UTILS_H_INCLUDED */
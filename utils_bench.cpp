@@ -0,0 +1,167 @@
+/**
+ * utils_bench.cpp - startup latency of the utilities, from exec to exit.
+ * runs each program given many times in turn, with its output thrown
+ * away, and reports the mean and fastest run of each; the first program
+ * is the baseline of the ratios. for GNU/Linux and other POSIX systems.
+ *
+ * build: g++ -O2 -std=c++17 utils_bench.cpp
+ *
+ * SYNOPSIS: utils_bench [-n runs] [-a argument] program...
+ *
+ * to compare the multi-call program with the separate utilities:
+ *
+ *   g++ -std=c++17 -O2 -o which which.cpp resolve.cpp operands.cpp mapfile.cpp
+ *   g++ -std=c++17 -O2 -static -pthread -DUTILS_MULTICALL -o utils ...
+ *       (the command in utils.cpp)
+ *   mkdir multi && ln -s ../utils multi/which
+ *   utils_bench -n 2000 -a ls ./which multi/which
+ *
+ * every program is run with the one argument (default "ls"), which is
+ * the name to look up for which, and must exit with status 0.
+ *
+ * free to distribute under the GPL license.
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ */
+
+
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+extern char **environ;
+
+
+typedef std::chrono::steady_clock Clock;
+
+struct Result
+{
+    double total;   /* seconds */
+    double fastest;
+    unsigned long failures;
+};
+
+
+/**
+ * run `program' once with `arg', its output going to /dev/null.
+ * returns false if it cannot be started or does not exit with 0.
+ */
+static bool runOnce(const char *program, const char *arg,
+                    posix_spawn_file_actions_t *actions)
+{
+    char *argv[] =
+    {
+        const_cast<char *>(program),
+        const_cast<char *>(arg),
+        NULL
+    };
+
+    pid_t pid;
+    if (posix_spawn(&pid, program, actions, NULL, argv, environ)) return false;
+
+    int status;
+    while (waitpid(pid, &status, 0) < 0)
+    {
+        if (errno != EINTR) return false;
+    }
+    return (WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+
+static void usage()
+{
+    fprintf(stderr, "usage: utils_bench [-n runs] [-a argument] program...\n");
+}
+
+
+int main(int argc, char **argv)
+{
+    unsigned long runs = 1000;
+    const char *arg = "ls";
+
+    int i = 1;
+    for (; i < argc && argv[i][0] == '-'; i += 2)
+    {
+        if (!argv[i][1] || argv[i][2] || i + 1 >= argc)
+        {
+            usage();
+            return EXIT_FAILURE;
+        }
+
+        char *end = NULL;
+        switch (argv[i][1])
+        {
+            case 'n': runs = strtoul(argv[i + 1], &end, 10);
+                      if (!*argv[i + 1] || *end || !runs)
+                      {
+                          usage();
+                          return EXIT_FAILURE;
+                      }
+                      break;
+
+            case 'a': arg = argv[i + 1];
+                      break;
+
+            default:  usage();
+                      return EXIT_FAILURE;
+        }
+    }
+
+    if (i == argc)
+    {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null",
+                                     O_WRONLY, 0);
+
+    /* the programs take turns, so that a change in load hits them alike. */
+    std::vector<Result> results(argc - i, Result());
+    for (std::size_t k = 0; k < results.size(); ++k) results[k].fastest = 1e9;
+
+    for (unsigned long run = 0; run < runs; ++run)
+    {
+        for (std::size_t k = 0; k < results.size(); ++k)
+        {
+            Clock::time_point start = Clock::now();
+            if (!runOnce(argv[i + k], arg, &actions)) ++results[k].failures;
+            double seconds =
+                std::chrono::duration<double>(Clock::now() - start).count();
+
+            results[k].total += seconds;
+            if (seconds < results[k].fastest) results[k].fastest = seconds;
+        }
+    }
+    posix_spawn_file_actions_destroy(&actions);
+
+    printf("%lu runs of each program with '%s'\n", runs, arg);
+
+    int status = EXIT_SUCCESS;
+    for (std::size_t k = 0; k < results.size(); ++k)
+    {
+        const Result& r = results[k];
+        printf("%-30s %10.1f us mean  %10.1f us fastest  %6.2fx  %8.2f s total\n",
+               argv[i + k],
+               r.total / runs * 1e6,
+               r.fastest * 1e6,
+               r.total / results[0].total,
+               r.total);
+
+        if (r.failures)
+        {
+            fprintf(stderr, "utils_bench: %s: %lu runs failed.\n",
+                    argv[i + k], r.failures);
+            status = EXIT_FAILURE;
+        }
+    }
+    return status;
+}
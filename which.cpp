@@ -10,203 +10,132 @@
  */
 
 
-#include <sys/stat.h>
-#include <cstring>
-#include <algorithm>
-#include <functional>
-#include <iostream>
-#include <iterator>
-#include <list>
-#include <string>
-#include <vector>
-
-
-#if defined(_MSC_VER)
-#   define strtok_r strtok_s
-#elif defined(__MINGW32__)
-
-    /**
-     * strtok_r - split string into tokens
-     * (C) Copyright 2009, 2010, Ji Han.
-     * see http://www.opengroup.org/onlinepubs/000095399/functions/strtok.html
-     * for the specification.
-     */
-    char* strtok_r(char* s, const char* sep, char** lasts)
-    {
-        if (s == NULL) s = *lasts;  // on subsequent calls, recover context first.
-        while (*s && strchr(sep, *s)) ++s;  // skip any leading separators.
-        if (*s == '\0')  // there's no more token.
-        {
-            *lasts = s;  // save context for subsequent calls.
-            return NULL;
-        }
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include "getopt.hpp"
+#include "operands.h"
+#include "output.h"
+#include "resolve.h"
+#include "utils.h"
 
-        char* ret = s;  // return the beginning of token.
-        while (!strchr(sep, *s)) ++s; // locate the end of token.
-        if (*s) *s++ = '\0';  // if this is not the last token, terminate with null byte.
-        *lasts = s;  // save context for subsequent calls.
-        return ret;
-    }
 
-#endif
-
-#if defined(_WIN32)
-    const static std::string Sep("\\");
-    const static std::string PathSep(";");
-#else
-    const static std::string Sep("/");
-    const static std::string PathSep(":");
-#endif
-
-
-static int id(int x)
+static bool print(std::string_view path, void *ctx)
 {
-    return x;
+    static_cast<Output *>(ctx)->line(path);
+    return true;
 }
 
-const static std::pointer_to_unary_function<int, int> Id(id);
 
+enum
+{
+    OPT_PREFIX = 256,
+    OPT_GLOB
+};
 
-struct FileExists
-    : std::unary_function<const std::string&, bool>
+static constexpr getopt::longopt longopts[] =
 {
-    bool operator()(const std::string& filename) const
-    {
-        struct stat buf;
-        return (!stat(filename.c_str(), &buf));
-    }
+    { "prefix", getopt::no_argument, OPT_PREFIX },
+    { "glob", getopt::no_argument, OPT_GLOB }
 };
 
+static constexpr auto optspec = getopt::make_spec("a", longopts);
+
 
 /**
- * get content of environment variable named `var',
- * transform the string with `transformer' (optional),
- * and split to a list of strings by `delims'.
+ * write out the matches; a write error fails the whole run.
  */
-std::list<std::string>
-splitStringGetEnv(const std::string& var,
-                  const std::string& delims,
-                  std::pointer_to_unary_function<int, int> transformer = Id)
+static int finish(Output& out, const getopt::operands& args)
 {
-    std::list<std::string> ret;
-
-    const char* lpVar = getenv(var.c_str());
-    if (lpVar == NULL) return ret;
-
-    std::string strVar(lpVar);
-    if (strVar.empty()) return ret;
-
-    transform(strVar.begin(), strVar.end(), strVar.begin(), transformer);
-
-    std::vector<char> buffer;
-    buffer.reserve(strVar.size());
-    std::copy(strVar.begin(), strVar.end(), back_inserter(buffer));
-
-    char* token = NULL;
-    const char* IFS = delims.c_str();
-    char* context = NULL;
-
-    token = strtok_r(&buffer.front(), IFS, &context);
-    while (token != NULL)
+    if (!out.flush())
     {
-        ret.push_back(std::string(token));
-        token = strtok_r(NULL, IFS, &context);
+        fprintf(stderr, "which: error writing the output.\n");
+        return EXIT_FAILURE;
     }
-
-    return ret;
+    return args.failures() ? EXIT_FAILURE : 0;
 }
 
 
-int main (int argc, char** argv)
+int which_main(int argc, char **argv)
 {
     if (argv[1] == NULL) return EXIT_FAILURE;
 
     bool toShowAllMatches = false;
-    int i = 1;
-    for (; argv[i] && *argv[i] == '-' && strcmp(argv[i], "-"); ++i)
+    enum { Lookup, Prefix, Glob } mode = Lookup;
+
+    getopt::parser opt(optspec);
+    for (int c; (c = opt(argc, argv)) != -1; )
     {
-        if (!strcmp(argv[i], "--"))
+        switch (c)
         {
-            ++i;
-            break;
-        }
+            case 'a':
+                toShowAllMatches = true;
+                break;
 
-        if (!strcmp(argv[i], "-a"))
-        {
-            toShowAllMatches = true;
-            continue;
-        }
+            case OPT_PREFIX:
+                mode = Prefix;
+                break;
 
-        // other options (if any) follow.
+            case OPT_GLOB:
+                mode = Glob;
+                break;
 
-        std::cerr << "Error: invalid option '" << *(argv + i) << "'.\n"
-                     "Usage: " << *argv << " [-a] args...\n";
-        return EXIT_FAILURE;
+            default:
+                if (opt.longopt())
+                {
+                    fprintf(stderr, "Error: invalid option '%s'.\n", opt.longopt());
+                }
+                else
+                {
+                    fprintf(stderr, "Error: invalid option '-%c'.\n", opt.optopt());
+                }
+                fprintf(stderr,
+                        "Usage: %s [-a] [--prefix | --glob] args... [@file]\n",
+                        *argv);
+                return EXIT_FAILURE;
+        }
     }
+    getopt::operands args("which", argc, argv, opt.optind());
+    Output out(stdout);
 
-    std::list<std::string> path = splitStringGetEnv("PATH", PathSep);
+    which::Resolver resolver;
+    resolver.init();
 
-#if defined(_WIN32)
-    std::list<std::string> pathext =
-        splitStringGetEnv("PATHEXT", PathSep, std::ptr_fun(::tolower));
-#endif
+    int flags = which::DefaultFlags;
+    if (toShowAllMatches) flags |= which::ALL;
 
-    for (; i < argc; ++i)
+    if (mode == Lookup)
     {
-        std::string filename(*(argv + i));
+        for (const char *arg; (arg = args.next()); )
+        {
+            resolver.resolve(arg, flags, print, &out);
+        }
+        return finish(out, args);
+    }
 
-#if defined(_WIN32)
-        // expand filename by PATHEXT (.EXE, .BAT, .VBS, .JS, etc.)
-        std::list<std::string> filenamesWithExt(pathext);
-        filenamesWithExt.insert(filenamesWithExt.begin(), std::string(""));
+    /* completion queries: list each directory once, then search the index. */
+    which::Index index;
+    index.build(resolver);
 
-        for (std::list<std::string>::iterator iter = filenamesWithExt.begin();
-             iter != filenamesWithExt.end();
-             ++iter)
+    for (const char *arg; (arg = args.next()); )
+    {
+        if (mode == Prefix)
         {
-            iter->insert(0, filename);
+            index.prefix(arg, flags, print, &out);
         }
-#else
-        std::list<std::string> filenamesWithExt(1, filename);
-#endif
-
-        for (std::list<std::string>::iterator iter = path.begin();
-             iter != path.end();
-             ++iter)
+        else
         {
-            std::string dirname(*iter);
-            dirname += Sep;
-            std::list<std::string> filespecs(filenamesWithExt);
-
-            for (std::list<std::string>::iterator iter = filespecs.begin();
-                 iter != filespecs.end();
-                 ++iter)
-            {
-                iter->insert(0, dirname);
-            }
-
-            filespecs.erase(remove_if(filespecs.begin(),
-                                      filespecs.end(),
-                                      std::not1(FileExists())),
-                            filespecs.end());
-
-            if (!filespecs.empty())
-            {
-                if (toShowAllMatches)
-                {
-                    std::copy(filespecs.begin(),
-                              filespecs.end(),
-                              std::ostream_iterator<std::string>(std::cout, "\n"));
-                }
-                else
-                {
-                    std::cout << *filespecs.begin() << std::endl;
-                    break;
-                }
-            }
+            index.glob(arg, flags, print, &out);
         }
     }
 
-    return 0;
+    return finish(out, args);
 }
 
+
+#if !defined(UTILS_MULTICALL)
+int main (int argc, char** argv)
+{
+    return which_main(argc, argv);
+}
+#endif
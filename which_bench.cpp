@@ -0,0 +1,452 @@
+/**
+ * which_bench.cpp - benchmark and regression harness for the PATH search.
+ * builds a synthetic PATH tree in a temporary directory and times
+ * single, -a and batch lookups through which::Resolver and which::Index.
+ * for GNU/Linux and other POSIX systems.
+ *
+ * build: g++ -O2 -std=c++17 -DWHICH_STATS which_bench.cpp resolve.cpp
+ *
+ * SYNOPSIS: which_bench [-d dirs] [-f files] [-s symlinks] [-x decoys]
+ *                       [-n lookups] [-b batch] [-m min_rate] [-k]
+ *
+ * directory i of the tree holds `files' executables t<i>_<j>,
+ * `symlinks' links l<i>_<j> to them, `decoys' non-executable t<i>_<j>.txt,
+ * one executable "common" shared by every directory and one subdirectory
+ * "subdir". a candidate matches if it exists and is not a directory
+ * (which::isProgram), so the decoys are found like the executables and
+ * "subdir" is never found.
+ * the probe counts are exact, so any change in the number of stat(2) calls
+ * per lookup is reported as a failure; -m also fails below a lookup rate.
+ *
+ * free to distribute under the GPL license.
+ * (C) Copyright 2009, 2010, Ji Han (jihan917<at>yahoo<dot>com).
+ */
+
+
+#if !defined(WHICH_STATS)
+#   error "which_bench needs resolve.cpp built with -DWHICH_STATS"
+#endif
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "resolve.h"
+
+
+struct Options
+{
+    unsigned dirs;
+    unsigned files;
+    unsigned symlinks;
+    unsigned decoys;
+    unsigned long lookups;
+    unsigned batch;
+    double minRate;
+    bool keep;
+};
+
+struct Query
+{
+    std::string name;
+    unsigned long probes;       /* expected stat(2) calls, single lookup */
+    unsigned long matches;      /* expected matches with -a */
+};
+
+
+static void usage()
+{
+    fprintf(stderr,
+            "usage: which_bench [-d dirs] [-f files] [-s symlinks] "
+            "[-x decoys] [-n lookups] [-b batch] [-m min_rate] [-k]\n");
+}
+
+
+static bool makeFile(const std::string& path, mode_t mode)
+{
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, mode);
+    if (fd < 0) return false;
+    close(fd);
+    return true;
+}
+
+
+static std::string entry(const char *prefix, unsigned i, unsigned j,
+                         const char *suffix = "")
+{
+    char name[64];
+    snprintf(name, sizeof name, "%s%u_%u%s", prefix, i, j, suffix);
+    return name;
+}
+
+
+/**
+ * create the PATH tree under `root'; returns the PATH string.
+ */
+static bool buildTree(const std::string& root, const Options& opts,
+                      std::string& path)
+{
+    path.clear();
+    for (unsigned i = 0; i < opts.dirs; ++i)
+    {
+        char name[32];
+        snprintf(name, sizeof name, "/d%u", i);
+        std::string dir = root + name;
+        if (mkdir(dir.c_str(), 0755)) return false;
+
+        if (i) path += which::PathSep;
+        path += dir;
+
+        if (!makeFile(dir + "/common", 0755)) return false;
+        if (mkdir((dir + "/subdir").c_str(), 0755)) return false;
+        for (unsigned j = 0; j < opts.files; ++j)
+        {
+            if (!makeFile(dir + "/" + entry("t", i, j), 0755)) return false;
+        }
+        for (unsigned j = 0; j < opts.symlinks && j < opts.files; ++j)
+        {
+            if (symlink(entry("t", i, j).c_str(),
+                        (dir + "/" + entry("l", i, j)).c_str()))
+            {
+                return false;
+            }
+        }
+        for (unsigned j = 0; j < opts.decoys; ++j)
+        {
+            if (!makeFile(dir + "/" + entry("t", i, j, ".txt"), 0644))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+static void removeTree(const std::string& root, const Options& opts)
+{
+    for (unsigned i = 0; i < opts.dirs; ++i)
+    {
+        char name[32];
+        snprintf(name, sizeof name, "/d%u", i);
+        std::string dir = root + name;
+
+        unlink((dir + "/common").c_str());
+        rmdir((dir + "/subdir").c_str());
+        for (unsigned j = 0; j < opts.files; ++j)
+        {
+            unlink((dir + "/" + entry("t", i, j)).c_str());
+            unlink((dir + "/" + entry("l", i, j)).c_str());
+        }
+        for (unsigned j = 0; j < opts.decoys; ++j)
+        {
+            unlink((dir + "/" + entry("t", i, j, ".txt")).c_str());
+        }
+        rmdir(dir.c_str());
+    }
+    rmdir(root.c_str());
+}
+
+
+/**
+ * a deterministic mix of hits at every depth, symbolic links, decoys,
+ * names shadowed in every directory, and misses, a directory among them.
+ */
+static std::vector<Query> makeQueries(const Options& opts, unsigned n)
+{
+    std::vector<Query> queries;
+    unsigned long seed = 12345;
+
+    for (unsigned k = 0; k < n; ++k)
+    {
+        seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+        unsigned i = static_cast<unsigned>(seed >> 33) % opts.dirs;
+        unsigned j = opts.files ? static_cast<unsigned>(seed >> 13) % opts.files : 0;
+
+        Query q;
+        switch (k % 8)
+        {
+            case 0:  q.name = "common";
+                     q.probes = 1;
+                     q.matches = opts.dirs;
+                     break;
+
+            case 1:  q.name = entry("missing", i, j);
+                     q.probes = opts.dirs;
+                     q.matches = 0;
+                     break;
+
+            case 2:  if (opts.files && j < opts.symlinks)
+                     {
+                         q.name = entry("l", i, j);
+                         q.probes = i + 1;
+                         q.matches = 1;
+                         break;
+                     }
+                     /* fall through */
+
+            case 3:  if (opts.decoys && k % 8 == 3)
+                     {
+                         /* execute permission is not checked. */
+                         unsigned x = static_cast<unsigned>(seed >> 23) % opts.decoys;
+                         q.name = entry("t", i, x, ".txt");
+                         q.probes = i + 1;
+                         q.matches = 1;
+                         break;
+                     }
+                     /* fall through */
+
+            case 4:  if (k % 8 == 4)
+                     {
+                         /* present in every directory, but a directory. */
+                         q.name = "subdir";
+                         q.probes = opts.dirs;
+                         q.matches = 0;
+                         break;
+                     }
+                     /* fall through */
+
+            default: if (opts.files)
+                     {
+                         q.name = entry("t", i, j);
+                         q.probes = i + 1;
+                         q.matches = 1;
+                     }
+                     else
+                     {
+                         q.name = entry("missing", i, j);
+                         q.probes = opts.dirs;
+                         q.matches = 0;
+                     }
+                     break;
+        }
+        queries.push_back(q);
+    }
+    return queries;
+}
+
+
+static bool count(std::string_view, void *)
+{
+    return true;
+}
+
+
+struct Result
+{
+    double seconds;
+    unsigned long lookups;
+    unsigned long matches;
+    which::Stats stats;
+};
+
+
+static void report(const char *label, const Result& r)
+{
+    double n = static_cast<double>(r.lookups);
+    printf("%-14s %12.0f lookups/s  %8.2f stat  %8.3f opendir  "
+           "%8.3f readdir  per lookup  (%lu matches)\n",
+           label,
+           n / r.seconds,
+           r.stats.stat / n,
+           r.stats.opendir / n,
+           r.stats.readdir / n,
+           r.matches);
+}
+
+
+typedef std::chrono::steady_clock Clock;
+
+
+static Result runResolver(const which::Resolver& resolver,
+                          const std::vector<Query>& queries,
+                          unsigned long lookups, int flags)
+{
+    which::stats = which::Stats();
+    Result r = { 0, lookups, 0, which::Stats() };
+
+    Clock::time_point start = Clock::now();
+    for (unsigned long k = 0; k < lookups; ++k)
+    {
+        const Query& q = queries[k % queries.size()];
+        r.matches += resolver.resolve(q.name, flags, count, NULL);
+    }
+    r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    r.stats = which::stats;
+    return r;
+}
+
+
+/**
+ * resolve a batch of names by listing every directory once.
+ */
+static Result runIndex(const which::Resolver& resolver,
+                       const std::vector<Query>& queries,
+                       int flags)
+{
+    which::stats = which::Stats();
+    Result r = { 0, queries.size(), 0, which::Stats() };
+
+    Clock::time_point start = Clock::now();
+    which::Index index;
+    index.build(resolver);
+    for (std::size_t k = 0; k < queries.size(); ++k)
+    {
+        /* a pattern without wildcards matches its name only. */
+        r.matches += index.glob(queries[k].name, flags, count, NULL);
+    }
+    r.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    r.stats = which::stats;
+    return r;
+}
+
+
+static bool parseCount(const char *s, unsigned long& value)
+{
+    char *end = NULL;
+    value = strtoul(s, &end, 10);
+    return (*s && !*end);
+}
+
+
+int main(int argc, char **argv)
+{
+    Options opts = { 16, 1000, 100, 100, 200000, 1000, 0, false };
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (!strcmp(argv[i], "-k"))
+        {
+            opts.keep = true;
+            continue;
+        }
+
+        unsigned long value;
+        if (argv[i][0] != '-' || !argv[i][1] || argv[i][2] ||
+            i + 1 >= argc || !parseCount(argv[i + 1], value))
+        {
+            usage();
+            return EXIT_FAILURE;
+        }
+
+        switch (argv[i++][1])
+        {
+            case 'd': opts.dirs = value; break;
+            case 'f': opts.files = value; break;
+            case 's': opts.symlinks = value; break;
+            case 'x': opts.decoys = value; break;
+            case 'n': opts.lookups = value; break;
+            case 'b': opts.batch = value; break;
+            case 'm': opts.minRate = value; break;
+            default:  usage();
+                      return EXIT_FAILURE;
+        }
+    }
+
+    if (!opts.dirs || !opts.lookups || !opts.batch)
+    {
+        usage();
+        return EXIT_FAILURE;
+    }
+
+    const char *tmp = getenv("TMPDIR");
+    std::string root(tmp && *tmp ? tmp : "/tmp");
+    root += "/which_bench.XXXXXX";
+    if (!mkdtemp(&root[0]))
+    {
+        perror("which_bench: mkdtemp");
+        return EXIT_FAILURE;
+    }
+
+    std::string path;
+    if (!buildTree(root, opts, path))
+    {
+        perror("which_bench: building the PATH tree");
+        removeTree(root, opts);
+        return EXIT_FAILURE;
+    }
+
+    printf("tree: %s (%u dirs x %u files, %u symlinks, %u decoys)\n",
+           root.c_str(), opts.dirs, opts.files, opts.symlinks, opts.decoys);
+
+    which::Resolver resolver;
+    resolver.init(path, "");
+
+    std::vector<Query> queries = makeQueries(opts, 4096);
+    std::vector<Query> batch = makeQueries(opts, opts.batch);
+
+    unsigned long probes = 0, matches = 0, all = 0;
+    for (unsigned long k = 0; k < opts.lookups; ++k)
+    {
+        const Query& q = queries[k % queries.size()];
+        probes += q.probes;
+        matches += (q.matches != 0);
+        all += q.matches;
+    }
+
+    unsigned long batchMatches = 0, batchAll = 0;
+    for (std::size_t k = 0; k < batch.size(); ++k)
+    {
+        batchMatches += (batch[k].matches != 0);
+        batchAll += batch[k].matches;
+    }
+
+    int status = EXIT_SUCCESS;
+
+    Result single = runResolver(resolver, queries, opts.lookups, 0);
+    report("single", single);
+    if (single.stats.stat != probes || single.matches != matches)
+    {
+        fprintf(stderr,
+                "which_bench: single: %lu stat calls and %lu matches, "
+                "expected %lu and %lu.\n",
+                single.stats.stat, single.matches, probes, matches);
+        status = EXIT_FAILURE;
+    }
+    if (opts.minRate && opts.lookups / single.seconds < opts.minRate)
+    {
+        fprintf(stderr, "which_bench: single: below %.0f lookups/s.\n",
+                opts.minRate);
+        status = EXIT_FAILURE;
+    }
+
+    Result every = runResolver(resolver, queries, opts.lookups, which::ALL);
+    report("-a", every);
+    if (every.stats.stat != opts.lookups * opts.dirs || every.matches != all)
+    {
+        fprintf(stderr,
+                "which_bench: -a: %lu stat calls and %lu matches, "
+                "expected %lu and %lu.\n",
+                every.stats.stat, every.matches,
+                opts.lookups * opts.dirs, all);
+        status = EXIT_FAILURE;
+    }
+
+    Result serial = runResolver(resolver, batch, batch.size(), 0);
+    report("batch stat", serial);
+
+    Result indexed = runIndex(resolver, batch, 0);
+    report("batch index", indexed);
+
+    Result indexedAll = runIndex(resolver, batch, which::ALL);
+    report("batch index -a", indexedAll);
+
+    if (serial.matches != batchMatches || indexed.matches != batchMatches ||
+        indexedAll.matches != batchAll)
+    {
+        fprintf(stderr,
+                "which_bench: batch: %lu, %lu and %lu matches, "
+                "expected %lu, %lu and %lu.\n",
+                serial.matches, indexed.matches, indexedAll.matches,
+                batchMatches, batchMatches, batchAll);
+        status = EXIT_FAILURE;
+    }
+
+    if (!opts.keep) removeTree(root, opts);
+    return status;
+}